@@ -5,7 +5,17 @@ HHVM_EXTENSION(aerospike-hhvm
     main/helper.cpp
     main/batch_op_manager.cpp
     main/scan_operation.cpp
-    main/udf_operations.cpp)
+    main/udf_operations.cpp
+    main/msgpack_packer.cpp
+    main/connection_registry.cpp
+    main/async_operations.cpp
+    main/batch_write_manager.cpp
+    main/batch_iterator.cpp
+    main/record_stream.cpp
+    main/record_stream_iterator.cpp
+    main/scan_iterator.cpp
+    main/query_iterator.cpp
+    main/scan_job.cpp)
 HHVM_DEFINE(aerospike-hhvm -DAEROSPIKE_C_CHECK)
 include_directories(include)
 target_link_libraries(aerospike-hhvm /usr/lib/libaerospike.so)
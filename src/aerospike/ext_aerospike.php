@@ -14,25 +14,45 @@ class Aerospike {
     <<__Native>>
         public static function setDeserializer(mixed $callback = NULL): bool;
     <<__Native>>
-        public function put(array $key, array $rec, int $ttl=0, mixed $options = NULL): int;
+        public function put(mixed $key, array $rec, int $ttl=0, mixed $options = NULL): int;
     <<__Native>>
-        public function get(array $key, mixed& $rec, mixed $filter = NULL, mixed $options = NULL): int;
+        public function get(mixed $key, mixed& $rec, mixed $filter = NULL, mixed $options = NULL): int;
     <<__Native>>
         public function dropIndex(mixed $ns, mixed $name, mixed $options = NULL): int;
     <<__Native>>
         public function addIndex(mixed $ns, mixed $set, mixed $bin, mixed $name, mixed $index_type, mixed $data_type, mixed $options = NULL): int;
     <<__Native>>
-        public function getMany(array $keys, mixed& $records, mixed $filter = NULL, mixed $options = NULL): int;
+        public function getMany(array $keys, mixed& $records, mixed $filter = NULL, mixed $options = NULL, mixed& $statuses = NULL): int;
     <<__Native>>
-        public function operate(array $key, array $operations, mixed& $returned = NULL, mixed $options = NULL): int;
+        public function getManyIterator(array $keys, mixed $filter = NULL, mixed $options = NULL): mixed;
     <<__Native>>
-        public function remove(array $key, mixed $options = NULL): int;
+        public function selectMany(array $keys_to_bins, mixed& $records, mixed $options = NULL, mixed& $statuses = NULL): int;
     <<__Native>>
-        public function removeBin(array $key, array $bins, mixed $options = NULL): int;
+        public function putMany(array $records, mixed& $statuses, int $ttl=0, mixed $options = NULL): int;
     <<__Native>>
-        public function exists(array $key, mixed& $metadata, mixed $options = NULL): int;
+        public function operate(mixed $key, array $operations, mixed& $returned = NULL, mixed $options = NULL): int;
     <<__Native>>
-        public function existsMany(array $keys, mixed& $metadata, mixed $options = NULL): int;
+        public function operateMany(array $keys_to_ops, mixed& $results, mixed $options = NULL): int;
+    <<__Native>>
+        public function remove(mixed $key, mixed $options = NULL): int;
+    <<__Native>>
+        public function removeBin(mixed $key, array $bins, mixed $options = NULL): int;
+    <<__Native>>
+        public function removeMany(array $keys, mixed& $statuses, mixed $options = NULL): int;
+    <<__Native>>
+        public function exists(mixed $key, mixed& $metadata, mixed $options = NULL): int;
+    <<__Native>>
+        public function existsMany(array $keys, mixed& $metadata, mixed $options = NULL, mixed& $statuses = NULL): int;
+    <<__Native>>
+        public function getAsync(mixed $key, mixed $filter = NULL, mixed $options = NULL): Awaitable<array>;
+    <<__Native>>
+        public function putAsync(mixed $key, array $rec, int $ttl=0, mixed $options = NULL): Awaitable<array>;
+    <<__Native>>
+        public function operateAsync(mixed $key, array $operations, mixed $options = NULL): Awaitable<array>;
+    <<__Native>>
+        public function removeAsync(mixed $key, mixed $options = NULL): Awaitable<array>;
+    <<__Native>>
+        public function existsAsync(mixed $key, mixed $options = NULL): Awaitable<array>;
     <<__Native>>
         public function getKeyDigest(mixed $ns, mixed $set, mixed $key): string;
     <<__Native>>
@@ -44,13 +64,17 @@ class Aerospike {
     <<__Native>>
         public function listRegistered(mixed& $modules, mixed $language = Aerospike::UDF_TYPE_LUA, mixed $options = NULL): int;
     <<__Native>>
-        public function apply(array $key, mixed $module, mixed $function, mixed $args = NULL, mixed &$returned = NULL, mixed $options = NULL): int;
+        public function apply(mixed $key, mixed $module, mixed $function, mixed $args = NULL, mixed &$returned = NULL, mixed $options = NULL): int;
     <<__Native>>
-        public function scan(mixed $ns, mixed $set, mixed $function, mixed $bins = NULL, mixed $options = NULL): int;
+        public function scan(mixed $ns, mixed $set, mixed $function, mixed $bins = NULL, mixed $options = NULL, mixed& $cursor = NULL): int;
+    <<__Native>>
+        public function scanIterator(mixed $ns, mixed $set, mixed $bins = NULL, mixed $options = NULL): mixed;
     <<__Native>>
         public function scanApply(mixed $ns, mixed $set, mixed $module, mixed $function, mixed $args, mixed &$scan_id, mixed $options = NULL): int;
     <<__Native>>
         public function scanInfo(mixed $scan_id, mixed &$scan_info, mixed $options = NULL): int;
+    <<__Native>>
+        public function scanJob(mixed $scan_id, mixed $options = NULL): mixed;
     <<__Native>>
         public static function predicateEquals(mixed $ns, mixed $value): mixed;
     <<__Native>>
@@ -61,6 +85,8 @@ class Aerospike {
         public static function predicateRange(mixed $ns, mixed $index_type, mixed $min, mixed $max): mixed;
     <<__Native>>
         public function query(mixed $ns, mixed $set, mixed $where, mixed $function, mixed $select = NULL, mixed $options = NULL): int;
+    <<__Native>>
+        public function queryIterator(mixed $ns, mixed $set, mixed $where, mixed $select = NULL, mixed $options = NULL): mixed;
     <<__Native>>
         public function aggregate(mixed $ns, mixed $set, mixed $where, mixed $module, mixed $function, mixed $args, mixed &$result, mixed $options = NULL): int;
     <<__Native>>
@@ -84,7 +110,7 @@ class Aerospike {
         return array("ns" => (string) $ns, "set" => (string) $set, "key" => $key);
     }
 
-    public function append(array $key, string $bin, mixed $value, mixed $options = NULL): int {
+    public function append(mixed $key, string $bin, mixed $value, mixed $options = NULL): int {
         $returned = NULL;
         if (!is_int($value) && !is_string($value)) {
             return NULL;
@@ -96,7 +122,7 @@ class Aerospike {
         return $this->operate($key, $operations, $returned, $options);
     }
 
-    public function prepend(array $key, string $bin, mixed $value, mixed $options = NULL): int {
+    public function prepend(mixed $key, string $bin, mixed $value, mixed $options = NULL): int {
         $returned = NULL;
         if (!is_int($value) && !is_string($value)) {
             return NULL;
@@ -108,16 +134,101 @@ class Aerospike {
         return $this->operate($key, $operations, $returned, $options);
     }
 
-    public function increment(array $key, string $bin, int $offset, mixed $options = NULL): int {
+    public function increment(mixed $key, string $bin, int $offset, mixed $options = NULL): int {
         $returned = NULL;
         $operations = array(array("op" => self::OPERATOR_INCR, "bin" => $bin, "val" => $offset));
         return $this->operate($key, $operations, $returned, $options);
     }
 
-    public function touch(array $key, int $ttl = 0, mixed $options = NULL): int {
+    public function touch(mixed $key, int $ttl = 0, mixed $options = NULL): int {
         $returned = NULL;
         $operations = array(array("op" => self::OPERATOR_TOUCH, "ttl" => $ttl));
         return $this->operate($key, $operations, $returned, $options);
     }
 }
 
+<<__NativeData("AerospikeKey")>>
+class AerospikeKey {
+    <<__Native>>
+        public function __construct(mixed $ns, mixed $set, mixed $key, bool $digest = false): void;
+    <<__Native>>
+        public function toArray(): array;
+}
+
+<<__NativeData("AerospikeBatchIterator")>>
+class AerospikeBatchIterator implements Iterator {
+    <<__Native>>
+        public function current(): mixed;
+    <<__Native>>
+        public function key(): mixed;
+    <<__Native>>
+        public function next(): void;
+    <<__Native>>
+        public function valid(): bool;
+    public function rewind(): void {
+    }
+    <<__Native>>
+        public function errorno(): int;
+    <<__Native>>
+        public function error(): string;
+}
+
+<<__NativeData("AerospikeScanIterator")>>
+class AerospikeScanIterator implements Iterator {
+    <<__Native>>
+        public function current(): mixed;
+    <<__Native>>
+        public function key(): mixed;
+    <<__Native>>
+        public function next(): void;
+    <<__Native>>
+        public function valid(): bool;
+    public function rewind(): void {
+    }
+    <<__Native>>
+        public function close(): void;
+    <<__Native>>
+        public function errorno(): int;
+    <<__Native>>
+        public function error(): string;
+}
+
+<<__NativeData("AerospikeQueryIterator")>>
+class AerospikeQueryIterator implements Iterator {
+    <<__Native>>
+        public function current(): mixed;
+    <<__Native>>
+        public function key(): mixed;
+    <<__Native>>
+        public function next(): void;
+    <<__Native>>
+        public function valid(): bool;
+    public function rewind(): void {
+    }
+    <<__Native>>
+        public function close(): void;
+    <<__Native>>
+        public function errorno(): int;
+    <<__Native>>
+        public function error(): string;
+}
+
+<<__NativeData("AerospikeScanJob")>>
+class AerospikeScanJob {
+    <<__Native>>
+        public function getId(): int;
+    <<__Native>>
+        public function info(mixed &$scan_info): int;
+    <<__Native>>
+        public function wait(int $timeout_ms = 0, int $interval_ms = 100): int;
+    <<__Native>>
+        public function errorno(): int;
+    <<__Native>>
+        public function error(): string;
+}
+
+<<__NativeData("AerospikePolicy")>>
+class AerospikePolicy {
+    <<__Native>>
+        public function __construct(Aerospike $db, array $options): void;
+}
@@ -0,0 +1,189 @@
+#ifndef __ASYNC_OPERATIONS_H__
+#define __ASYNC_OPERATIONS_H__
+
+#include "hphp/runtime/ext/extension.h"
+#include "hphp/runtime/ext/asio/asio-external-thread-event.h"
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+extern "C" {
+#include "aerospike/aerospike.h"
+#include "aerospike/aerospike_key.h"
+#include "aerospike/as_status.h"
+#include "aerospike/as_error.h"
+#include "aerospike/as_record.h"
+#include "aerospike/as_operations.h"
+}
+
+#include "connection_registry.h"
+
+namespace HPHP {
+    /*
+     * No. of worker threads executing the commands of the *Async() methods,
+     * shared by all the requests of the process.
+     */
+#define ASYNC_COMMAND_WORKERS 16
+
+    const StaticString s_error("error");
+    const StaticString s_record("record");
+    const StaticString s_returned("returned");
+
+    /*
+     ************************************************************************************
+     * AerospikeAsyncEvent class, the base of the events backing the
+     * Awaitables returned by the *Async() methods.
+     * The PHP arguments are converted on the request thread into C client
+     * values owned by the event, the command is executed on a worker thread
+     * of the AsyncCommandPool and the C client's results are converted back
+     * into PHP values on the request thread, in unserialize().
+     * Since an abandoned event may be destroyed by the worker thread, an
+     * event never holds request allocated memory.
+     ************************************************************************************
+     * Methods:
+     ************************************************************************************
+     * 1. Use set_key() to take an owned copy of the key of the command, and
+     * own_record_values()/own_operations_values() to make the converted
+     * record/operations independent of the PHP values they were built from.
+     * 2. Use dispatch() to queue the command, or to finish the event at once
+     * with the given error if the arguments could not be converted.
+     * 3. execute() runs the command on the worker thread, build_result()
+     * populates the result array on the request thread.
+     ************************************************************************************
+     */
+    class AerospikeAsyncEvent : public AsioExternalThreadEvent {
+        public:
+            AerospikeAsyncEvent(aerospike_ref *as_ref_p);
+            virtual ~AerospikeAsyncEvent();
+
+            void set_key(const as_key& key);
+            void dispatch(const as_error& error);
+            void run();
+
+        protected:
+            aerospike_ref   *as_ref_p;
+            as_key          key;
+            bool            key_initialized = false;
+            as_error        error;
+
+            virtual void execute() = 0;
+            virtual void build_result(Array& php_result) {}
+            void unserialize(Cell& result) override final;
+    };
+
+    /*
+     ************************************************************************************
+     * Events of the individual *Async() methods.
+     ************************************************************************************
+     */
+    class AsyncGetEvent : public AerospikeAsyncEvent {
+        public:
+            as_policy_read              read_policy;
+            std::vector<std::string>    filter_bins;
+            bool                        has_filter = false;
+
+            AsyncGetEvent(aerospike_ref *as_ref_p) : AerospikeAsyncEvent(as_ref_p) {}
+            ~AsyncGetEvent();
+
+        protected:
+            as_record                   *rec_p = NULL;
+
+            void execute() override;
+            void build_result(Array& php_result) override;
+    };
+
+    class AsyncPutEvent : public AerospikeAsyncEvent {
+        public:
+            as_policy_write             write_policy;
+            as_record                   rec;
+            bool                        rec_initialized = false;
+
+            AsyncPutEvent(aerospike_ref *as_ref_p) : AerospikeAsyncEvent(as_ref_p) {}
+            ~AsyncPutEvent();
+
+        protected:
+            void execute() override;
+    };
+
+    class AsyncOperateEvent : public AerospikeAsyncEvent {
+        public:
+            as_policy_operate           operate_policy;
+            as_operations               operations;
+            bool                        operations_initialized = false;
+
+            AsyncOperateEvent(aerospike_ref *as_ref_p) : AerospikeAsyncEvent(as_ref_p) {}
+            ~AsyncOperateEvent();
+
+        protected:
+            as_record                   *rec_p = NULL;
+
+            void execute() override;
+            void build_result(Array& php_result) override;
+    };
+
+    class AsyncRemoveEvent : public AerospikeAsyncEvent {
+        public:
+            as_policy_remove            remove_policy;
+
+            AsyncRemoveEvent(aerospike_ref *as_ref_p) : AerospikeAsyncEvent(as_ref_p) {}
+
+        protected:
+            void execute() override;
+    };
+
+    class AsyncExistsEvent : public AerospikeAsyncEvent {
+        public:
+            as_policy_read              read_policy;
+
+            AsyncExistsEvent(aerospike_ref *as_ref_p) : AerospikeAsyncEvent(as_ref_p) {}
+            ~AsyncExistsEvent();
+
+        protected:
+            as_record                   *rec_p = NULL;
+
+            void execute() override;
+            void build_result(Array& php_result) override;
+    };
+
+    /*
+     ************************************************************************************
+     * AsyncCommandPool class, a process wide pool of worker threads running
+     * the commands of AerospikeAsyncEvents and the jobs of the batch write
+     * methods. The C client is built without an event loop, so each command
+     * runs the blocking C client call on a worker thread; the request thread
+     * is free to issue more commands meanwhile.
+     ************************************************************************************
+     * Methods:
+     ************************************************************************************
+     * 1. Use enqueue() to queue a job. The workers are started on first use.
+     * 2. Use shutdown() at module shutdown to drain the queue and join the
+     * workers.
+     ************************************************************************************
+     */
+    class AsyncCommandPool {
+        private:
+            std::mutex                          lock;
+            std::condition_variable             cond;
+            std::deque<std::function<void()>>   queue;
+            std::vector<std::thread>            workers;
+            bool                                stopping = false;
+
+            void worker_loop();
+
+        public:
+            bool enqueue(std::function<void()> job);
+            void shutdown();
+    };
+
+    extern AsyncCommandPool async_command_pool;
+    extern as_val* as_val_to_owned_as_val(as_val *value_p);
+    extern as_status own_record_values(as_record& rec, as_error& error);
+    extern as_status own_operations_values(as_operations& operations, as_error& error);
+    extern void wait_for_async_commands(aerospike_ref *as_ref_p);
+} // namespace HPHP
+#endif /* end of __ASYNC_OPERATIONS_H__ */
@@ -0,0 +1,111 @@
+#ifndef __BATCH_ITERATOR_H__
+#define __BATCH_ITERATOR_H__
+
+#include "hphp/runtime/ext/extension.h"
+#include "hphp/runtime/base/execution-context.h"
+#include "hphp/runtime/vm/native-data.h"
+
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <vector>
+
+extern "C" {
+#include "aerospike/aerospike.h"
+#include "aerospike/aerospike_batch.h"
+#include "aerospike/as_batch.h"
+#include "aerospike/as_status.h"
+#include "aerospike/as_policy.h"
+}
+
+#include "connection_registry.h"
+
+namespace HPHP {
+    /*
+     * No. of keys read by a single batch command of an AerospikeBatchIterator,
+     * and the no. of such commands it keeps in flight. At most
+     * BATCH_ITERATOR_CHUNK_SIZE * (BATCH_ITERATOR_MAX_IN_FLIGHT + 1) records
+     * are held by an iterator at any time.
+     */
+#define BATCH_ITERATOR_CHUNK_SIZE 256
+#define BATCH_ITERATOR_MAX_IN_FLIGHT 4
+
+    const StaticString s_AerospikeBatchIterator("AerospikeBatchIterator");
+
+    /*
+     ************************************************************************************
+     * Structure holding a chunk of the keys of an AerospikeBatchIterator,
+     * read by a single batch command, along with its results.
+     ************************************************************************************
+     */
+    typedef struct batch_iterator_chunk {
+        as_batch_read_records   *records_p = NULL;
+        uint32_t                first_key = 0;
+        as_error                error;
+    } batch_iterator_chunk;
+
+    /*
+     ************************************************************************************
+     * AerospikeBatchIterator class, the native data of the PHP
+     * AerospikeBatchIterator class returned by Aerospike::getManyIterator().
+     * The keys are split into chunks, each read by a batch command run on
+     * the AsyncCommandPool; up to BATCH_ITERATOR_MAX_IN_FLIGHT chunks are
+     * read ahead of the one being iterated. The records of a chunk are
+     * yielded as soon as the chunk completes, in completion order, and are
+     * converted into PHP values one at a time, on the request thread.
+     ************************************************************************************
+     * Methods:
+     ************************************************************************************
+     * 1. Use init() to validate the keys and start reading the first chunks.
+     * 2. Use valid(), current(), key() and next() to iterate, as the PHP
+     * Iterator methods of the same names do. key() is the key of the record's
+     * key in the PHP keys array, current() is the record, or NULL if it does
+     * not exist or could not be read.
+     * 3. Use getErrorCode()/getErrorMessage() to get the first error met.
+     ************************************************************************************
+     */
+    class AerospikeBatchIterator {
+        private:
+            Object                              db;
+            aerospike_ref                       *as_ref_p = NULL;
+            as_policy_batch                     batch_policy;
+            std::vector<Variant>                php_keys;
+            std::vector<Variant>                php_key_indexes;
+            std::vector<std::string>            filter_bins;
+            std::vector<char *>                 filter_bins_p;
+            bool                                has_filter = false;
+            uint32_t                            next_key = 0;
+            bool                                is_initialized = false;
+
+            std::mutex                          lock;
+            std::condition_variable             cond;
+            std::deque<batch_iterator_chunk *>  completed;
+            uint32_t                            in_flight = 0;
+
+            batch_iterator_chunk                *chunk_p = NULL;
+            uint32_t                            position = 0;
+            as_error                            error;
+
+            void dispatch_chunks();
+            bool fetch_chunk();
+            static void destroy_chunk(batch_iterator_chunk *chunk_p);
+
+        public:
+            AerospikeBatchIterator();
+            AerospikeBatchIterator(const AerospikeBatchIterator&) = delete;
+            AerospikeBatchIterator& operator=(const AerospikeBatchIterator&) = delete;
+            ~AerospikeBatchIterator();
+
+            as_status init(const Object& db, aerospike_ref *as_ref_p,
+                    const Array& php_keys, const Variant& php_filter_bins,
+                    const as_policy_batch& batch_policy, as_error& error);
+            bool valid();
+            Variant current();
+            Variant key();
+            void next();
+            as_status getErrorCode() const { return error.code; }
+            String getErrorMessage() const;
+    };
+}
+#endif /* end of __BATCH_ITERATOR_H__ */
@@ -1,5 +1,5 @@
 #ifndef __BATCH_OP_MANAGER_H__
-#define __BATHC_OP_MANAGER_H__
+#define __BATCH_OP_MANAGER_H__
 
 #include "hphp/runtime/ext/extension.h"
 #include "hphp/runtime/base/execution-context.h"
@@ -14,7 +14,69 @@ extern "C" {
 #include "aerospike/as_policy.h"
 }
 
+#include <vector>
+
+#include "policy.h"
+
 namespace HPHP {
+    /*
+     ************************************************************************************
+     * Structure holding the result and the status arrays to be populated by
+     * the batch read callbacks, the error to be populated in case of errors,
+     * whether the results are positional, the bitmap to be populated instead
+     * of data by a batch exists returning a bit per key, and the no. of keys
+     * which failed along with the status of the first of them.
+     ************************************************************************************
+     */
+    typedef struct batch_read_udata {
+        Array&      data;
+        Array&      statuses;
+        as_error&   error;
+        bool        positional;
+        unsigned char *bitmap_p = NULL;
+        uint32_t    failed = 0;
+        as_status   failed_status = AEROSPIKE_OK;
+        batch_read_udata(Array& init_data, Array& init_statuses, as_error& init_error,
+                bool init_positional) :
+            data(init_data), statuses(init_statuses), error(init_error),
+            positional(init_positional) {}
+    } batch_read_udata;
+
+    /*
+     ************************************************************************************
+     * Structure holding a sub-batch of a batch read split into sub-batches:
+     * the range of the keys it reads, or their positions if they are not
+     * contiguous, and its results.
+     ************************************************************************************
+     */
+    typedef struct batch_read_chunk {
+        as_batch_read_records   *records_p = NULL;
+        uint32_t                first_key = 0;
+        const uint32_t          *positions_p = NULL;
+        uint32_t                size = 0;
+        as_error                error;
+    } batch_read_chunk;
+
+    /*
+     ************************************************************************************
+     * Structure holding what is read for a key of a batch read with per-key
+     * bin selection: all the bins, the n_bin_names bins starting at
+     * first_bin_name in the bin names of the batch, or only the metadata.
+     ************************************************************************************
+     */
+    typedef struct batch_read_shape {
+        uint32_t                first_bin_name = 0;
+        uint32_t                n_bin_names = 0;
+        bool                    read_all_bins = true;
+    } batch_read_shape;
+
+    /*
+     * Function converting the result of a key of a batch read into udata,
+     * at the given position of the key in the batch.
+     */
+    typedef bool (*batch_result_populator)(as_status result, as_record *record_p,
+            as_key *key_p, uint32_t position, batch_read_udata *udata);
+
     /*
      ************************************************************************************
      * BatchOpManager class to invoke the following batch operations:
@@ -30,29 +92,81 @@ namespace HPHP {
      ************************************************************************************
      * 1. Use execute_batch_exists() to perform a batch exists operation on the
      * keys provided in the constructor; returns the collective metadata of the
-     * said records within the VRefParam php_metadata.
-     * 1. Use execute_batch_get() to perform a batch get operation on the
+     * said records within the VRefParam php_metadata. Use
+     * execute_batch_exists_flags() instead to only get whether each key
+     * exists, as a string holding a bit per key or a list holding a boolean
+     * per key, in the order of the keys.
+     * 2. Use execute_batch_get() to perform a batch get operation on the
      * keys provided in the constructor; returns all the said records within
      * the VRefParam php_records.
+     * 3. Use prepare_batch_read() to set the bins to be read for each key,
+     * then execute_batch_read() to read them with a single batch command
+     * per node; returns the record of each key within php_records, under
+     * the same key as in the PHP array given to prepare_batch_read().
+     * Both return an array keyed by the record keys, or when positional is
+     * set, a list holding the result of each key at the position of the key
+     * in the PHP keys array, along with the status of each key in the same
+     * shape within php_statuses. A key which failed does not fail the others.
+     * Batches larger than the chunk size of the given batch_chunking are split
+     * into sub-batches of contiguous keys, read concurrently by the workers
+     * of the AsyncCommandPool and the calling thread; a sub-batch which times
+     * out is read again on its own, and the keys which still failed may be
+     * read again, on their own as well. The results are converted on the
+     * calling thread once all the keys are read.
      ************************************************************************************
      */
     class BatchOpManager {
         private:
             as_batch batch;
+            std::vector<batch_read_shape> shapes;
+            std::vector<const char *> bin_names;
+            static Array create_positional_result(uint32_t size,
+                    const Variant& value = init_null());
             static void populate_result_for_get_exists_many(as_key *key_p,
-                    Array& outer_meta_array, Array& inner_meta_array,
+                    Array& outer_meta_array, const Variant& inner_meta_array,
                     as_error& error);
+            static void populate_result(as_key *key_p, uint32_t position,
+                    const Variant& value, as_status status, batch_read_udata *udata);
+            static as_status set_failed_keys_error(const batch_read_udata& udata,
+                    as_error& error);
+            bool is_chunked(const batch_chunking& chunking) const;
+            batch_chunking whole_batch_chunking(const batch_chunking& chunking) const;
+            static bool populate_exists_result(as_status result, as_record *record_p,
+                    as_key *key_p, uint32_t position, batch_read_udata *udata);
+            static bool populate_exists_flag(as_status result, as_record *record_p,
+                    as_key *key_p, uint32_t position, batch_read_udata *udata);
+            static bool populate_get_result(as_status result, as_record *record_p,
+                    as_key *key_p, uint32_t position, batch_read_udata *udata);
             static bool batch_exists_cb(const as_batch_read* results, uint32_t n, void* udata);
+            static bool batch_exists_flags_cb(const as_batch_read* results, uint32_t n, void* udata);
             static bool batch_get_cb(const as_batch_read* results, uint32_t n, void* udata);
+            void read_chunk(aerospike *as_p, as_policy_batch& batch_policy,
+                    batch_read_chunk& chunk, const char **filter,
+                    uint32_t filter_size, bool read_bins, uint32_t retries) const;
+            as_status execute_chunks(aerospike *as_p, as_policy_batch& batch_policy,
+                    const batch_chunking& chunking, const char **filter,
+                    uint32_t filter_size, bool read_bins,
+                    batch_result_populator populate, batch_read_udata& udata,
+                    as_error& error);
         public:
             BatchOpManager();
             ~BatchOpManager();
             BatchOpManager(const Array& php_keys);
             as_status execute_batch_exists(aerospike *as_p, Array &php_metadata,
-                    as_policy_batch& batch_policy, as_error& error);
+                    Array &php_statuses, as_policy_batch& batch_policy, bool positional,
+                    const batch_chunking& chunking, as_error& error);
+            as_status execute_batch_exists_flags(aerospike *as_p, Variant &php_flags,
+                    Array &php_statuses, as_policy_batch& batch_policy, int16_t format,
+                    const batch_chunking& chunking, as_error& error);
             as_status execute_batch_get(aerospike *as_p, Array &php_records,
-                    const Variant& filter_bins, as_policy_batch& batch_policy,
+                    Array &php_statuses, const Variant& filter_bins,
+                    as_policy_batch& batch_policy,
+                    bool positional, const batch_chunking& chunking,
                     as_error& error);
+            as_status prepare_batch_read(const Array& php_keys_to_bins, as_error& error);
+            as_status execute_batch_read(aerospike *as_p, const Array& php_keys_to_bins,
+                    Array &php_records, Array &php_statuses, as_policy_batch& batch_policy,
+                    const batch_chunking& chunking, as_error& error);
     };
 }
 #endif /* end of __BATCH_OP_MANAGER_H__ */
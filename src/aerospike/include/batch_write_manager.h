@@ -0,0 +1,108 @@
+#ifndef __BATCH_WRITE_MANAGER_H__
+#define __BATCH_WRITE_MANAGER_H__
+
+#include "hphp/runtime/ext/extension.h"
+#include "hphp/runtime/base/execution-context.h"
+#include "hphp/runtime/vm/native-data.h"
+
+#include <functional>
+
+extern "C" {
+#include "aerospike/aerospike.h"
+#include "aerospike/aerospike_key.h"
+#include "aerospike/as_status.h"
+#include "aerospike/as_policy.h"
+#include "aerospike/as_record.h"
+#include "aerospike/as_operations.h"
+}
+
+#include "conversions.h"
+#include "policy.h"
+
+namespace HPHP {
+    /*
+     * Minimum no. of records written by a single job of a batch write.
+     * Smaller batches use fewer jobs, down to a single job run by the
+     * request thread itself.
+     */
+#define BATCH_WRITE_MIN_JOB_SIZE 16
+
+    /*
+     ************************************************************************************
+     * Structure holding a record, or the operations on a record, of a batch
+     * write along with its result.
+     ************************************************************************************
+     */
+    typedef struct batch_write_entry {
+        as_key          key;
+        as_record       rec;
+        as_operations   operations;
+        as_record       *result_p = NULL;
+        bool            key_initialized = false;
+        bool            rec_initialized = false;
+        bool            operations_initialized = false;
+        as_status       status = AEROSPIKE_OK;
+    } batch_write_entry;
+
+    /*
+     ************************************************************************************
+     * BatchWriteManager class to invoke the following batch write operations:
+     * 1. batch put() aka Aerospike::putMany()
+     * 2. batch operate() aka Aerospike::operateMany()
+     * 3. batch remove() aka Aerospike::removeMany()
+     * The server has no batch write command, hence the records are written
+     * with one command each, but concurrently: the records are split into
+     * contiguous ranges, each of which is written by a job run on the workers
+     * of the AsyncCommandPool while the request thread writes the first range
+     * and then waits for the others.
+     * The records are converted once, on the request thread, before any job
+     * starts, and are destroyed along with this object.
+     ************************************************************************************
+     * Methods:
+     ************************************************************************************
+     * 1. Use prepare_puts() to convert the PHP records array.
+     * 2. Use execute_puts() to write them; returns the status of each record
+     * within php_statuses, under the same key as in the PHP records array.
+     * 3. Use prepare_operates() to convert the operations of each key.
+     * 4. Use execute_operates() to perform them; returns the status and the
+     * bins returned by the operations of each key within php_results.
+     * 5. Use prepare_removes() to convert the keys of a batch remove.
+     * 6. Use execute_removes() to remove them; returns the status of each key
+     * within php_statuses, as execute_puts() does.
+     ************************************************************************************
+     */
+    class BatchWriteManager {
+        private:
+            batch_write_entry   *entries_p = NULL;
+            uint32_t            entries_size = 0;
+            StaticPoolManager   static_pool;
+
+            as_status execute_jobs(const std::function<as_status(batch_write_entry&, as_error&)>& write,
+                    as_error& error);
+            void populate_statuses(const Array& php_records, Array& php_statuses);
+
+        public:
+            BatchWriteManager(const Array& php_records);
+            BatchWriteManager(const BatchWriteManager&) = delete;
+            BatchWriteManager& operator=(const BatchWriteManager&) = delete;
+            ~BatchWriteManager();
+
+            as_status prepare_puts(const Array& php_records, int64_t ttl,
+                    PolicyManager& policy_manager, const Variant& options,
+                    int16_t serializer_option, as_error& error);
+            as_status execute_puts(aerospike *as_p, const Array& php_records,
+                    Array& php_statuses, as_policy_write& write_policy,
+                    as_error& error);
+            as_status prepare_operates(const Array& php_keys_to_ops,
+                    PolicyManager& policy_manager, const Variant& options,
+                    int16_t serializer_option, as_error& error);
+            as_status execute_operates(aerospike *as_p, const Array& php_keys_to_ops,
+                    Array& php_results, as_policy_operate& operate_policy,
+                    as_error& error);
+            as_status prepare_removes(const Array& php_keys, as_error& error);
+            as_status execute_removes(aerospike *as_p, const Array& php_keys,
+                    Array& php_statuses, as_policy_remove& remove_policy,
+                    as_error& error);
+    };
+}
+#endif /* end of __BATCH_WRITE_MANAGER_H__ */
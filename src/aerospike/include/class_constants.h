@@ -117,6 +117,19 @@ namespace HPHP {
         { AS_OPERATOR_APPEND                    ,   "OPERATOR_APPEND"                   },
         { AS_OPERATOR_TOUCH                     ,   "OPERATOR_TOUCH"                    },
         { OPT_TTL                               ,   "OPT_TTL"                           },
+        { OPT_BATCH_POSITIONAL                  ,   "OPT_BATCH_POSITIONAL"              },
+        { OPT_BATCH_CHUNK_SIZE                  ,   "OPT_BATCH_CHUNK_SIZE"              },
+        { OPT_BATCH_MAX_IN_FLIGHT               ,   "OPT_BATCH_MAX_IN_FLIGHT"           },
+        { OPT_BATCH_CHUNK_RETRIES               ,   "OPT_BATCH_CHUNK_RETRIES"           },
+        { OPT_BATCH_RETRY_FAILED_KEYS           ,   "OPT_BATCH_RETRY_FAILED_KEYS"       },
+        { OPT_BATCH_EXISTS_FORMAT               ,   "OPT_BATCH_EXISTS_FORMAT"           },
+        { BATCH_EXISTS_METADATA                 ,   "BATCH_EXISTS_METADATA"             },
+        { BATCH_EXISTS_BITMAP                   ,   "BATCH_EXISTS_BITMAP"               },
+        { BATCH_EXISTS_BOOLS                    ,   "BATCH_EXISTS_BOOLS"                },
+        { OPT_SCAN_BUFFER_SIZE                  ,   "OPT_SCAN_BUFFER_SIZE"              },
+        { OPT_CALLBACK_CHUNK_SIZE               ,   "OPT_CALLBACK_CHUNK_SIZE"           },
+        { OPT_SCAN_PARTITIONS                   ,   "OPT_SCAN_PARTITIONS"               },
+        { OPT_MAX_RECORDS                       ,   "OPT_MAX_RECORDS"                   },
 };
 
 #define EXTENSION_CONSTANTS_SIZE (sizeof(extension_constants)/sizeof(aerospike_constants))
@@ -0,0 +1,84 @@
+#ifndef __CONNECTION_REGISTRY_H__
+#define __CONNECTION_REGISTRY_H__
+
+#include <atomic>
+
+extern "C" {
+#include "aerospike/aerospike.h"
+#include "aerospike/as_config.h"
+#include "aerospike/as_error.h"
+}
+
+namespace HPHP {
+    /*
+     * No. of slots in the persistent connection registry. Must be a power of 2.
+     * Each slot holds one cluster configuration for the lifetime of the process.
+     */
+#define PERSISTENT_REGISTRY_SLOTS 256
+
+    /*
+     *******************************************************************************************************
+     * Structure containing C client's aerospike object and its reference counter.
+     *******************************************************************************************************
+     */
+    typedef struct csdk_aerospike_object {
+        /*
+         * as_p holds the reference of internal C SDK aerospike object
+         */
+        aerospike *as_p = NULL;
+
+        /*
+         * ref_php_object indicates the no. of references for internal C
+         * SDK aerospike object being held by the various PHP userland Aerospike
+         * objects.
+         */
+        std::atomic<int> ref_php_object{0};
+
+        /*
+         * ref_async_commands indicates the no. of commands of *Async() methods
+         * still being executed on this object by the AsyncCommandPool, and of
+         * scans/queries still running on the threads of RecordStreams.
+         */
+        std::atomic<int> ref_async_commands{0};
+
+        /*
+         * config_hash is the hash of the cluster configuration (hosts and user)
+         * this object was created with, see
+         * PersistentConnectionRegistry::hash_config().
+         */
+        uint64_t config_hash = 0;
+    } aerospike_ref;
+
+    /*
+     ************************************************************************************
+     * PersistentConnectionRegistry class to share C client aerospike objects
+     * between requests, keyed by the hash of the cluster configuration.
+     * The registry is a fixed size open addressing table of atomic slots.
+     * Entries are only ever added while the process runs and are removed at
+     * module shutdown, hence lookups are lock-free and never allocate, and an
+     * entry found by a lookup stays valid for as long as the process lives.
+     ************************************************************************************
+     * Methods:
+     ************************************************************************************
+     * 1. Use hash_config() to compute the key of a cluster configuration.
+     * 2. Use find() to look up the entry for a configuration.
+     * 3. Use insert() to publish a new entry. If another thread published an
+     * entry for the same configuration first, that entry is returned instead.
+     * 4. Use close_all() at module shutdown to close and free all entries.
+     ************************************************************************************
+     */
+    class PersistentConnectionRegistry {
+        private:
+            std::atomic<aerospike_ref *> slots[PERSISTENT_REGISTRY_SLOTS];
+            static bool config_matches(const as_config& config, const aerospike_ref *entry_p);
+        public:
+            PersistentConnectionRegistry();
+            static uint64_t hash_config(const as_config& config);
+            aerospike_ref* find(const as_config& config, uint64_t config_hash);
+            aerospike_ref* insert(const as_config& config, aerospike_ref *entry_p);
+            void close_all(as_error& error);
+    };
+
+    extern PersistentConnectionRegistry persistent_registry;
+}
+#endif /* end of __CONNECTION_REGISTRY_H__ */
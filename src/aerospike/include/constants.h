@@ -34,7 +34,17 @@ namespace HPHP {
         OPT_POLICY_REPLICA,       /* set to one of Aerospike::POLICY_REPLICA_* */
         OPT_POLICY_CONSISTENCY,   /* set to one of Aerospike::POLICY_CONSISTENCY_* */
         OPT_POLICY_COMMIT_LEVEL,  /* set to one of Aerospike::POLICY_COMMIT_LEVEL_* */
-        OPT_TTL                   /* set to time-to-live of the record in seconds */
+        OPT_TTL,                  /* set to time-to-live of the record in seconds */
+        OPT_BATCH_POSITIONAL,     /* boolean value, default: false; batch results are a list in the order of the keys */
+        OPT_BATCH_CHUNK_SIZE,     /* no. of keys per sub-batch of a batch read, default: 5000, 0 disables splitting */
+        OPT_BATCH_MAX_IN_FLIGHT,  /* no. of sub-batches of a batch read in flight, default: 4 */
+        OPT_BATCH_CHUNK_RETRIES,  /* no. of times a timed out sub-batch is re-requested, default: 1 */
+        OPT_BATCH_RETRY_FAILED_KEYS, /* no. of times the keys which failed are re-requested, default: 0 */
+        OPT_BATCH_EXISTS_FORMAT,  /* set to a Aerospike::BATCH_EXISTS_* value */
+        OPT_SCAN_BUFFER_SIZE,     /* no. of records buffered by a scan iterator, query or concurrent scan, default: 1024 */
+        OPT_CALLBACK_CHUNK_SIZE,  /* no. of records per call of a scan/query callback, default: 0, one record not in a list */
+        OPT_SCAN_PARTITIONS,      /* array of the first and the last partition scanned, within 0-4095 */
+        OPT_MAX_RECORDS           /* max no. of records returned by a scan/query, default: 0, no limit */
     };
 
     /*
@@ -52,6 +62,18 @@ namespace HPHP {
 
     #define SERIALIZER_DEFAULT "1"
 
+    /*
+     *******************************************************************************************************
+     * Enum for PHP client's BATCH_EXISTS_* constant values. Possible values
+     * for OPT_BATCH_EXISTS_FORMAT.
+     *******************************************************************************************************
+     */
+    enum Aerospike_batch_exists_values {
+        BATCH_EXISTS_METADATA,                              /* default, metadata array of each key */
+        BATCH_EXISTS_BITMAP,                                /* string holding a bit per key */
+        BATCH_EXISTS_BOOLS,                                 /* list holding a boolean per key */
+    };
+
     #if HHVM_VERSION_BRANCH >= 201216
         #define UNINIT_NULL_VARIANT    uninit_variant
     #else
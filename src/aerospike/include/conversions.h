@@ -5,6 +5,9 @@
 #include "hphp/runtime/base/execution-context.h"
 #include "hphp/runtime/vm/native-data.h"
 #include "hphp/runtime/base/builtin-functions.h"
+#include "hphp/runtime/base/array-init.h"
+
+#include <vector>
 
 extern "C" {
 #include "aerospike/aerospike_key.h"
@@ -14,6 +17,10 @@ extern "C" {
 #include "aerospike/as_arraylist.h"
 #include "aerospike/as_map.h"
 #include "aerospike/as_hashmap.h"
+#include "aerospike/as_double.h"
+#include "aerospike/as_boolean.h"
+#include "aerospike/as_iterator.h"
+#include "aerospike/as_pair.h"
 }
 
 
@@ -26,6 +33,8 @@ namespace HPHP {
      */
     extern as_status php_config_to_as_config(const Array& php_config, as_config& config, as_error& error);
     extern as_status php_key_to_as_key(const Array& php_key, as_key& key, as_error& error);
+    extern as_status php_key_to_as_key(const Variant& php_key, as_key& key, as_error& error);
+    extern void as_key_to_owned_as_key(const as_key& key, as_key& owned_key);
     extern as_status php_record_to_as_record(const Array& php_record, as_record& record, int64_t ttl, StaticPoolManager& static_pool, int16_t serializer_type, as_error& error);
     extern as_status php_variant_to_as_val(const Variant& php_variant, as_val **val_pp, StaticPoolManager& static_pool, int16_t serializer_type, as_error& error);
     extern as_status php_list_to_as_list(const Array& php_list, as_list **list_pp, StaticPoolManager& static_pool, int16_t serializer_type, as_error& error);
@@ -42,37 +51,139 @@ namespace HPHP {
 
     /*
      **************************************************************************************************
-     * Class to manage a static pool of as_string, as_integer, as_arraylist, as_hashmap for use in
+     * Size in bytes of each chunk handed out to a ChunkedPool, and the maximum
+     * no. of such chunks kept in the per-thread cache between two conversions.
+     **************************************************************************************************
+     */
+    static const uint32_t POOL_CHUNK_SIZE = 4096;
+    static const uint32_t POOL_CHUNK_CACHE_MAX = 256;
+
+    extern void* acquire_pool_chunk();
+    extern void release_pool_chunk(void *chunk_p);
+    extern void free_pool_chunk_cache();
+
+    /*
+     **************************************************************************************************
+     * Class template to manage a growable pool of a single as_* datatype.
+     * Elements are carved out of fixed size chunks, which are acquired lazily
+     * only when the current chunk is exhausted. Hence a conversion touches only
+     * as much memory as the record needs and there is no upper limit on the
+     * no. of elements. Addresses of the elements handed out remain stable for
+     * the lifetime of the pool, as nested as_list/as_map hold pointers to them.
+     **************************************************************************************************
+     */
+    template <typename T>
+    class ChunkedPool {
+        private:
+            static const uint32_t   ELEMENTS_PER_CHUNK = POOL_CHUNK_SIZE / sizeof(T);
+            std::vector<T *>        chunks;
+            uint32_t                index = 0;
+
+        public:
+            T* get()
+            {
+                uint32_t chunk_iter = index / ELEMENTS_PER_CHUNK;
+                if (chunk_iter == chunks.size()) {
+                    T *chunk_p = (T *) acquire_pool_chunk();
+                    if (!chunk_p) {
+                        return NULL;
+                    }
+                    chunks.push_back(chunk_p);
+                }
+                return &chunks[chunk_iter][index++ % ELEMENTS_PER_CHUNK];
+            }
+
+            uint32_t size() const
+            {
+                return index;
+            }
+
+            T* at(uint32_t iter) const
+            {
+                return &chunks[iter / ELEMENTS_PER_CHUNK][iter % ELEMENTS_PER_CHUNK];
+            }
+
+            void release()
+            {
+                for (auto chunk_p : chunks) {
+                    release_pool_chunk(chunk_p);
+                }
+                chunks.clear();
+                index = 0;
+            }
+    };
+
+    /*
+     **************************************************************************************************
+     * Class to manage a pool of as_string, as_integer, as_double, as_boolean, as_arraylist, as_hashmap,
+     * as_bytes for use in
      * the flow of conversions.
-     * Instantiate this class and invoke methods to make use of stack allocated
+     * Instantiate this class and invoke methods to make use of pool allocated
      * as_* datatypes in order to avoid mallocs via use of as_*_new() APIs.
+     * The pools grow on demand in POOL_CHUNK_SIZE steps, so the object itself is
+     * only a few words on the stack. Chunks released by the destructor are kept
+     * in a per-thread cache, which lets the following calls within the same
+     * request reuse them; the cache is freed at request shutdown.
      **************************************************************************************************
      */
 
     class StaticPoolManager {
         private:
-            static const uint32_t       STATIC_POOL_MAX_SIZE = 4096;
-            as_string                   string_pool[STATIC_POOL_MAX_SIZE];
-            as_integer                  integer_pool[STATIC_POOL_MAX_SIZE];
-            as_arraylist                list_pool[STATIC_POOL_MAX_SIZE];
-            as_hashmap                  map_pool[STATIC_POOL_MAX_SIZE];
-            as_bytes                    bytes_pool[STATIC_POOL_MAX_SIZE];
-            uint32_t                    string_pool_index = 0;
-            uint32_t                    integer_pool_index = 0;
-            uint32_t                    list_pool_index = 0;
-            uint32_t                    map_pool_index = 0;
-            uint32_t                    bytes_pool_index = 0;
+            ChunkedPool<as_string>      string_pool;
+            ChunkedPool<as_integer>     integer_pool;
+            ChunkedPool<as_double>      double_pool;
+            ChunkedPool<as_boolean>     boolean_pool;
+            ChunkedPool<as_arraylist>   list_pool;
+            ChunkedPool<as_hashmap>     map_pool;
+            ChunkedPool<as_bytes>       bytes_pool;
 
         public:
             StaticPoolManager();
             as_string* get_as_string();
             as_integer* get_as_integer();
+            as_double* get_as_double();
+            as_boolean* get_as_boolean();
             as_arraylist* get_as_arraylist();
             as_hashmap* get_as_hashmap();
             as_bytes* get_as_bytes();
             ~StaticPoolManager();
     };
 
+    const StaticString s_AerospikeKey("AerospikeKey");
+
+    /*
+     ************************************************************************************
+     * AerospikeKey class, the native data of the PHP AerospikeKey class.
+     * Holds an as_key which owns copies of the namespace, set and primary key,
+     * and the digest of which is computed once at initialization. Keys passed
+     * to the Aerospike methods as AerospikeKey objects are neither validated
+     * nor hashed again.
+     ************************************************************************************
+     * Methods:
+     ************************************************************************************
+     * 1. Use init() to initialize the as_key, once.
+     * 2. Use alias_to() to set a caller's as_key to refer to the held one,
+     * digest included, for the duration of a call.
+     * 3. Use fromVariant() to get the AerospikeKey of a PHP AerospikeKey object.
+     ************************************************************************************
+     */
+    class AerospikeKey {
+        public:
+            as_key  key;
+            bool    is_initialized = false;
+            bool    is_digest = false;
+
+            AerospikeKey() {}
+            AerospikeKey(const AerospikeKey&) = delete;
+            AerospikeKey& operator=(const AerospikeKey&) = delete;
+            ~AerospikeKey();
+
+            as_status init(const Variant& ns, const Variant& set, const Variant& primary_key,
+                    bool is_digest, as_error& error);
+            void alias_to(as_key& alias) const;
+            static AerospikeKey* fromVariant(const Variant& php_key);
+    };
+
     /*
      ************************************************************************************
      * Structure declaration for foreach_callback_udata.
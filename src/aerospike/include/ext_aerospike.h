@@ -13,38 +13,14 @@ extern "C" {
 }
 
 #include "constants.h"
+#include "conversions.h"
+#include "connection_registry.h"
 #include "hphp/runtime/ext/extension.h"
 #include "hphp/runtime/base/request-local.h"
 
 namespace HPHP {
 #define MAX_PORT_SIZE 6
 
-    /*
-     *******************************************************************************************************
-     * Structure containing C client's aerospike object and its reference counter.
-     *******************************************************************************************************
-     */
-    typedef struct csdk_aerospike_object {
-        /*
-         * as_p holds the reference of internal C SDK aerospike object
-         */
-        aerospike *as_p;
-
-        /*
-         * ref_as_p indicates the no. of references for internal C
-         * SDK aerospike object being held by the various PHP userland Aerospike
-         * objects.
-         */
-        int ref_php_object;
-
-        /*
-         * ref_hosts_entry indicates the no. of references for internal C
-         * SDK aerospike object being held by entries in aerospike global
-         * persistent_list hashtable.
-         */
-        int ref_host_entry;
-    } aerospike_ref;
-
     /*
      ************************************************************************************
      * Constant Static Strings used throughout the extension code.
@@ -64,6 +40,8 @@ namespace HPHP {
     const StaticString s_ttl("ttl");
     const StaticString s_generation("generation");
     const StaticString s_bins("bins");
+    const StaticString s_operations("operations");
+    const StaticString s_header_only("header_only");
     const StaticString s_op("op");
     const StaticString s_bin("bin");
     const StaticString s_val("val");
@@ -79,13 +57,18 @@ namespace HPHP {
     const StaticString s_shm_max_namespaces("shm_max_namespaces");
     const StaticString s_shm_takeover_threshold_sec("shm_takeover_threshold_sec");
     
-    /* Request-local globals for serializer/deserializer */
+    /*
+     * Request-local globals for serializer/deserializer.
+     * Request shutdown also frees the conversion pool chunks cached by this
+     * request's thread.
+     */
     struct AerospikeRequestLocals : RequestEventHandler {
         Variant serializer, deserializer;
         void requestInit() override {}
         void requestShutdown() override {
             serializer = UNINIT_NULL_VARIANT;
             deserializer = UNINIT_NULL_VARIANT;
+            free_pool_chunk_cache();
         }
     };
 
@@ -133,19 +116,27 @@ namespace HPHP {
                 }
                 return UNINIT_NULL_VARIANT;
             }
+            static void initRequestLocals() {
+                locals.get();
+            }
 
             as_status configure_connection(as_config& config, as_error& error);
 
             void setError(const as_error& error);
-            const as_error& getError() { return latest_error; }
+            as_status getErrorCode() const { return latest_error_code; }
+            String getErrorMessage() const;
 
         private:
             DECLARE_STATIC_REQUEST_LOCAL(AerospikeRequestLocals, locals);
+            /*
+             * latest_error_code is set by every call. latest_error is only
+             * written when a call fails and is valid only while
+             * latest_error_code is not AEROSPIKE_OK.
+             */
+            as_status latest_error_code = AEROSPIKE_OK;
             as_error latest_error;
-            pthread_rwlock_t latest_error_mutex;
 
             void create_new_host_entry(as_config& config, as_error& error);
-            void iterate_hosts_add_entry(as_config& config, int matched_host_id);
     };
 
 } // namespace HPHP
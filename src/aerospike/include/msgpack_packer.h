@@ -0,0 +1,65 @@
+#ifndef __MSGPACK_PACKER_H__
+#define __MSGPACK_PACKER_H__
+
+#include "hphp/runtime/ext/extension.h"
+
+extern "C" {
+#include "aerospike/as_status.h"
+#include "aerospike/as_error.h"
+#include "aerospike/as_bytes.h"
+}
+
+namespace HPHP {
+#define MSGPACK_PACKER_INITIAL_CAPACITY 256
+
+    /*
+     ************************************************************************************
+     * MsgpackPacker class to serialize values into the Aerospike flavour of
+     * msgpack, i.e. the wire format of list and map bins.
+     * The packer owns a growable heap buffer. Once a complete list/map is
+     * packed, use release_to_as_bytes() to hand the buffer over to an as_bytes
+     * of type AS_BYTES_LIST/AS_BYTES_MAP, which the C client then writes to
+     * the server as is, without building and re-serializing an as_val tree.
+     ************************************************************************************
+     * Methods:
+     ************************************************************************************
+     * 1. Use pack_*() methods to append msgpack encoded values to the buffer.
+     * Strings and serialized blobs are prefixed with their as_bytes_type
+     * byte, the same way the C client's as_msgpack serializer does it.
+     * 2. Use release_to_as_bytes() to transfer the ownership of the buffer
+     * to an as_bytes. The packer is reset and may be reused afterwards.
+     ************************************************************************************
+     */
+    class MsgpackPacker {
+        private:
+            uint8_t     *buffer_p = NULL;
+            uint32_t    size = 0;
+            uint32_t    capacity = 0;
+            bool        failed = false;
+
+            bool reserve(uint32_t length);
+            void write_byte(uint8_t byte);
+            void write_bytes(const void *bytes_p, uint32_t length);
+            void write_be16(uint16_t value);
+            void write_be32(uint32_t value);
+            void write_be64(uint64_t value);
+            void pack_raw_header(uint32_t length);
+
+        public:
+            MsgpackPacker() {}
+            ~MsgpackPacker();
+
+            void pack_nil();
+            void pack_int64(int64_t value);
+            void pack_double(double value);
+            void pack_bool(bool value);
+            void pack_list_header(uint32_t count);
+            void pack_map_header(uint32_t count);
+            void pack_string(const char *str_p, uint32_t length);
+            void pack_blob(as_bytes_type bytes_type, const char *blob_p, uint32_t length);
+
+            as_status release_to_as_bytes(as_bytes *bytes_p, as_bytes_type bytes_type, as_error& error);
+            void reset();
+    };
+} // namespace HPHP
+#endif /* end of __MSGPACK_PACKER_H__ */
@@ -11,10 +11,128 @@ extern "C" {
 #include "aerospike/aerospike_key.h"
 #include "aerospike/as_status.h"
 #include "aerospike/as_policy.h"
+#include "aerospike/as_scan.h"
 #include "constants.h"
 }
 
 namespace HPHP {
+    const StaticString s_AerospikePolicy("AerospikePolicy");
+
+    /*
+     *******************************************************************************************
+     * Policy types handled by PolicyManager, resolved once from the type string
+     * passed to initPolicyManager().
+     *******************************************************************************************
+     */
+    enum policy_type {
+        POLICY_TYPE_NONE,
+        POLICY_TYPE_READ,
+        POLICY_TYPE_WRITE,
+        POLICY_TYPE_OPERATE,
+        POLICY_TYPE_REMOVE,
+        POLICY_TYPE_INFO,
+        POLICY_TYPE_SCAN,
+        POLICY_TYPE_QUERY,
+        POLICY_TYPE_APPLY,
+        POLICY_TYPE_ADMIN,
+        POLICY_TYPE_BATCH
+    };
+
+    /*
+     * Defaults of the splitting of the batch reads into sub-batches.
+     */
+#define BATCH_CHUNK_SIZE_DEFAULT 5000
+#define BATCH_MAX_IN_FLIGHT_DEFAULT 4
+#define BATCH_CHUNK_RETRIES_DEFAULT 1
+
+    /*
+     * Default no. of records buffered by a scan iterator.
+     */
+#define SCAN_BUFFER_SIZE_DEFAULT 1024
+
+    /*
+     * Max no. of records passed to each call of a scan/query callback.
+     */
+#define CALLBACK_CHUNK_SIZE_MAX 65536
+
+    /*
+     * No. of partitions of a namespace.
+     */
+#define SCAN_PARTITIONS_COUNT 4096
+
+    /*
+     ************************************************************************************
+     * Structure holding the range of partitions a scan is restricted to, the
+     * first and the last partition included. is_set is true if the user's
+     * options specified it.
+     ************************************************************************************
+     */
+    typedef struct scan_partition_range {
+        bool            is_set = false;
+        uint16_t        begin = 0;
+        uint16_t        end = SCAN_PARTITIONS_COUNT - 1;
+    } scan_partition_range;
+
+    /*
+     ************************************************************************************
+     * Structure holding how a batch read is split into sub-batches: the no.
+     * of keys per sub-batch (0 to read the batch at once), the no. of
+     * sub-batches read concurrently, the no. of times a sub-batch which
+     * timed out is read again and the no. of times the keys which failed are
+     * read again.
+     ************************************************************************************
+     */
+    typedef struct batch_chunking {
+        uint32_t        chunk_size = BATCH_CHUNK_SIZE_DEFAULT;
+        uint32_t        max_in_flight = BATCH_MAX_IN_FLIGHT_DEFAULT;
+        uint32_t        retries = BATCH_CHUNK_RETRIES_DEFAULT;
+        uint32_t        failed_key_retries = 0;
+    } batch_chunking;
+
+    /*
+     ************************************************************************************
+     * AerospikePolicy class, the native data of the PHP AerospikePolicy class.
+     * Holds an options array precompiled against the policy defaults of an
+     * Aerospike object: one ready as_policy_* per policy type, the scan
+     * settings and the serializer/gen/ttl/connect timeout values if the
+     * options specified them.
+     * PolicyManager copies from it instead of parsing the options array, when
+     * an AerospikePolicy object is passed to a method in place of $options.
+     ************************************************************************************
+     */
+    class AerospikePolicy {
+        public:
+            bool            is_compiled = false;
+            as_policies     policies;
+            bool            has_serializer = false;
+            int16_t         serializer_value = SERIALIZER_PHP;
+            bool            has_gen_value = false;
+            uint16_t        gen_value = 0;
+            bool            has_ttl_value = false;
+            uint32_t        ttl_value = 0;
+            bool            has_batch_positional = false;
+            bool            batch_positional = false;
+            bool            has_batch_chunking = false;
+            batch_chunking  chunking;
+            bool            has_batch_exists_format = false;
+            int16_t         batch_exists_format = BATCH_EXISTS_METADATA;
+            bool            has_conn_timeout = false;
+            uint32_t        conn_timeout_ms = 0;
+            as_scan_priority scan_priority = AS_SCAN_PRIORITY_AUTO;
+            uint8_t         scan_percent = 100;
+            bool            scan_concurrent = false;
+            bool            scan_no_bins = false;
+            bool            has_scan_buffer_size = false;
+            uint32_t        scan_buffer_size = SCAN_BUFFER_SIZE_DEFAULT;
+            bool            has_callback_chunk_size = false;
+            uint32_t        callback_chunk_size = 0;
+            scan_partition_range scan_partitions;
+            bool            has_max_records = false;
+            uint64_t        max_records = 0;
+
+            as_status compile(const as_config *config_p, const Array& options, as_error& error);
+            static AerospikePolicy* fromVariant(const Variant& options_variant);
+    };
     /*
      *******************************************************************************************
      * Structure for INI entries
@@ -59,14 +177,40 @@ namespace HPHP {
      * the passed pointer by parsing the user's options array.
      * 4. Use set_ttl_value() method to set the time-to-live value within
      * the passed pointer by parsing the user's options array.
+     * 5. Use set_batch_positional() method to set whether the results of a
+     * batch read are positional within the passed pointer by parsing the
+     * user's options array.
+     * 6. Use set_batch_chunking() method to set how a batch read is split into
+     * sub-batches within the passed pointer by parsing the user's options
+     * array.
+     * 7. Use set_batch_exists_format() method to set how the result of a
+     * batch exists is returned within the passed pointer by parsing the
+     * user's options array.
+     * 8. Use set_scan_buffer_size() method to set the no. of records buffered
+     * by a scan iterator, a query or a concurrent scan within the passed pointer by parsing the user's
+     * options array.
+     * 9. Use set_callback_chunk_size() method to set the no. of records
+     * passed to each call of a scan/query callback within the passed pointer
+     * by parsing the user's options array.
+     * 10. Use set_scan_partitions() method to set the range of partitions a
+     * scan is restricted to within the passed pointer by parsing the user's
+     * options array.
+     * 11. Use set_max_records() method to set the max no. of records returned
+     * by a scan/query within the passed pointer by parsing the user's options
+     * array.
+     * Wherever an options array is accepted, a precompiled AerospikePolicy
+     * object may be passed instead, in which case nothing is parsed.
      ************************************************************************************
      */
     class PolicyManager {
         private:
             void *policy_holder;
             char *type;
+            policy_type type_id = POLICY_TYPE_NONE;
             as_config *config_p;
             bool initialize_policy();
+            as_status set_compiled_policy(const AerospikePolicy *compiled_p, int16_t *serializer_value,
+                    int16_t global_serializer_val, as_error& error);
             as_status copy_INI_entries_to_config(as_error& error);
             as_status set_config_policies(const Variant& options, as_error& error);
         public:
@@ -83,6 +227,13 @@ namespace HPHP {
             as_status set_global_defaults(int16_t *serializer_value, const Variant& options, as_error& error);
             as_status set_generation_value(uint16_t *gen_value, const Variant& options, as_error& error);
             as_status set_ttl_value(uint32_t *ttl_value_p, const Variant& options_variant, as_error& error);
+            as_status set_batch_positional(bool *positional_p, const Variant& options_variant, as_error& error);
+            as_status set_batch_chunking(batch_chunking *chunking_p, const Variant& options_variant, as_error& error);
+            as_status set_batch_exists_format(int16_t *format_p, const Variant& options_variant, as_error& error);
+            as_status set_scan_buffer_size(uint32_t *buffer_size_p, const Variant& options_variant, as_error& error);
+            as_status set_callback_chunk_size(uint32_t *chunk_size_p, const Variant& options_variant, as_error& error);
+            as_status set_scan_partitions(scan_partition_range *range_p, const Variant& options_variant, as_error& error);
+            as_status set_max_records(uint64_t *max_records_p, const Variant& options_variant, as_error& error);
 
 /*
  *******************************************************************************************
@@ -97,6 +248,10 @@ namespace HPHP {
                 /*TBD: Handle failure */                        \
             }
 
+            /* Caller of Macro should check for validity of this->policy_holder */
+#define POLICY_COPY_COMPILED(type, compiled_p) \
+            as_policy_##type##_copy((as_policy_##type *) &((compiled_p)->policies.type), CURRENT_POLICY(type))
+
             /* Caller of Macro should check for validity of this->policy_holder */
 #define CURRENT_POLICY(type) \
             ((as_policy_##type *) (this->policy_holder))
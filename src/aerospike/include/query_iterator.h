@@ -0,0 +1,53 @@
+#ifndef __QUERY_ITERATOR_H__
+#define __QUERY_ITERATOR_H__
+
+#include "hphp/runtime/ext/extension.h"
+#include "hphp/runtime/base/execution-context.h"
+#include "hphp/runtime/vm/native-data.h"
+
+extern "C" {
+#include "aerospike/aerospike.h"
+#include "aerospike/aerospike_query.h"
+#include "aerospike/as_record.h"
+#include "aerospike/as_query.h"
+#include "aerospike/as_status.h"
+#include "aerospike/as_policy.h"
+}
+
+#include "connection_registry.h"
+#include "record_stream_iterator.h"
+
+namespace HPHP {
+    const StaticString s_AerospikeQueryIterator("AerospikeQueryIterator");
+
+    /*
+     ************************************************************************************
+     * AerospikeQueryIterator class, the native data of the PHP
+     * AerospikeQueryIterator class returned by Aerospike::queryIterator().
+     * The query runs through the RecordStream of its RecordStreamIterator.
+     ************************************************************************************
+     * Methods:
+     ************************************************************************************
+     * 1. Use init() to validate the query and start it.
+     * 2. Iterate as a RecordStreamIterator.
+     ************************************************************************************
+     */
+    class AerospikeQueryIterator : public RecordStreamIterator {
+        private:
+            as_query                            query;
+            bool                                query_initialized = false;
+            as_policy_query                     query_policy;
+
+        public:
+            AerospikeQueryIterator() = default;
+            AerospikeQueryIterator(const AerospikeQueryIterator&) = delete;
+            AerospikeQueryIterator& operator=(const AerospikeQueryIterator&) = delete;
+            ~AerospikeQueryIterator();
+
+            as_status init(const Object& db, aerospike_ref *as_ref_p,
+                    const Variant& ns, const Variant& set, const Variant& where,
+                    const Variant& bins, const as_policy_query& query_policy,
+                    uint32_t buffer_size, uint64_t max_records, as_error& error);
+    };
+}
+#endif /* end of __QUERY_ITERATOR_H__ */
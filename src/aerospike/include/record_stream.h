@@ -0,0 +1,85 @@
+#ifndef __RECORD_STREAM_H__
+#define __RECORD_STREAM_H__
+
+#include "hphp/runtime/ext/extension.h"
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+
+extern "C" {
+#include "aerospike/aerospike.h"
+#include "aerospike/as_record.h"
+#include "aerospike/as_status.h"
+#include "aerospike/as_error.h"
+}
+
+#include "connection_registry.h"
+
+namespace HPHP {
+    /*
+     * Interval in milliseconds at which a C client thread blocked on a full
+     * RecordStream checks whether the connection of the stream was closed.
+     */
+#define RECORD_STREAM_POLL_MS 100
+
+    /*
+     ************************************************************************************
+     * RecordStream class, hands the records of a scan or a query over from
+     * the C client threads to the request thread.
+     * The scan/query runs on a thread of its own, with callback() as its
+     * callback and the stream as its udata. It is kept off the fixed no. of
+     * workers of the AsyncCommandPool, since a stream which is not drained
+     * blocks its thread for as long as it is open. The C client threads only
+     * copy each record into an owned as_record and append it to a buffer of
+     * at most capacity records, blocking while the buffer is full, which
+     * stops reading from the sockets and so holds the server back. No PHP
+     * value is ever built or called off the request thread. Once max_records
+     * records were buffered, if set, the callback returns false, so the C
+     * client stops the scan/query on every node.
+     ************************************************************************************
+     * Methods:
+     ************************************************************************************
+     * 1. Use start() to run the scan/query on the thread of the stream.
+     * 2. Use pop() on the request thread to take the records one at a time,
+     * or foreach() to pass them all to a scan/query callback.
+     * 3. Use close() to stop the scan/query before its end and free the
+     * buffer. It joins the thread of the stream. The destructor closes the
+     * stream as well.
+     ************************************************************************************
+     */
+    class RecordStream {
+        private:
+            aerospike_ref               *as_ref_p = NULL;
+            uint32_t                    capacity = 0;
+            uint64_t                    max_records = 0;
+            uint64_t                    n_records = 0;
+            std::mutex                  lock;
+            std::condition_variable     cond;
+            std::deque<as_record *>     buffer;
+            std::thread                 worker;
+            bool                        is_running = false;
+            bool                        is_closed = false;
+            as_error                    error;
+
+            bool push(as_record *record_p);
+
+        public:
+            RecordStream();
+            RecordStream(const RecordStream&) = delete;
+            RecordStream& operator=(const RecordStream&) = delete;
+            ~RecordStream();
+
+            as_status start(aerospike_ref *as_ref_p, uint32_t capacity,
+                    uint64_t max_records, std::function<void(as_error&)> run,
+                    as_error& error);
+            static bool callback(const as_val *val_p, void *udata);
+            bool pop(as_record **record_pp, as_error& error);
+            as_status foreach(bool (*record_cb)(const as_val *, void *), void *udata,
+                    as_error& error);
+            void close();
+    };
+}
+#endif /* end of __RECORD_STREAM_H__ */
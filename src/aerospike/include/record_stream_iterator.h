@@ -0,0 +1,65 @@
+#ifndef __RECORD_STREAM_ITERATOR_H__
+#define __RECORD_STREAM_ITERATOR_H__
+
+#include "hphp/runtime/ext/extension.h"
+#include "hphp/runtime/base/execution-context.h"
+#include "hphp/runtime/vm/native-data.h"
+
+extern "C" {
+#include "aerospike/aerospike.h"
+#include "aerospike/as_record.h"
+#include "aerospike/as_status.h"
+#include "aerospike/as_error.h"
+}
+
+#include "record_stream.h"
+
+namespace HPHP {
+    /*
+     ************************************************************************************
+     * RecordStreamIterator class, the base of the native data of the PHP
+     * iterators over the records of a scan or a query. The scan/query runs
+     * through a RecordStream, started by the init() of the derived class,
+     * and its records are converted into PHP values one at a time, on the
+     * request thread, as they are iterated.
+     ************************************************************************************
+     * Methods:
+     ************************************************************************************
+     * 1. Use valid(), current(), key() and next() to iterate, as the PHP
+     * Iterator methods of the same names do. key() is the no. of the record
+     * within the scan/query, current() is the record.
+     * 2. Use close() to stop the scan/query before its end and free the
+     * buffer. The destructor of a derived class must close the iterator
+     * before it destroys what the scan/query reads.
+     * 3. Use getErrorCode()/getErrorMessage() to get the first error met.
+     ************************************************************************************
+     */
+    class RecordStreamIterator {
+        protected:
+            Object                              db;
+            bool                                is_initialized = false;
+            RecordStream                        stream;
+
+            Variant                             record;
+            bool                                has_record = false;
+            int64_t                             position = -1;
+            as_error                            error;
+
+            bool fetch_record();
+
+        public:
+            RecordStreamIterator();
+            RecordStreamIterator(const RecordStreamIterator&) = delete;
+            RecordStreamIterator& operator=(const RecordStreamIterator&) = delete;
+            ~RecordStreamIterator();
+
+            bool valid();
+            Variant current();
+            Variant key();
+            void next();
+            void close();
+            as_status getErrorCode() const { return error.code; }
+            String getErrorMessage() const;
+    };
+}
+#endif /* end of __RECORD_STREAM_ITERATOR_H__ */
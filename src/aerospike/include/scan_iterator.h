@@ -0,0 +1,53 @@
+#ifndef __SCAN_ITERATOR_H__
+#define __SCAN_ITERATOR_H__
+
+#include "hphp/runtime/ext/extension.h"
+#include "hphp/runtime/base/execution-context.h"
+#include "hphp/runtime/vm/native-data.h"
+
+extern "C" {
+#include "aerospike/aerospike.h"
+#include "aerospike/aerospike_scan.h"
+#include "aerospike/as_record.h"
+#include "aerospike/as_scan.h"
+#include "aerospike/as_status.h"
+#include "aerospike/as_policy.h"
+}
+
+#include "connection_registry.h"
+#include "record_stream_iterator.h"
+
+namespace HPHP {
+    const StaticString s_AerospikeScanIterator("AerospikeScanIterator");
+
+    /*
+     ************************************************************************************
+     * AerospikeScanIterator class, the native data of the PHP
+     * AerospikeScanIterator class returned by Aerospike::scanIterator().
+     * The scan runs through the RecordStream of its RecordStreamIterator.
+     ************************************************************************************
+     * Methods:
+     ************************************************************************************
+     * 1. Use init() to validate the scan and start it.
+     * 2. Iterate as a RecordStreamIterator.
+     ************************************************************************************
+     */
+    class AerospikeScanIterator : public RecordStreamIterator {
+        private:
+            as_scan                             scan;
+            bool                                scan_initialized = false;
+            as_policy_scan                      scan_policy;
+
+        public:
+            AerospikeScanIterator() = default;
+            AerospikeScanIterator(const AerospikeScanIterator&) = delete;
+            AerospikeScanIterator& operator=(const AerospikeScanIterator&) = delete;
+            ~AerospikeScanIterator();
+
+            as_status init(const Object& db, aerospike_ref *as_ref_p,
+                    const Variant& ns, const Variant& set, const Variant& bins,
+                    const Variant& options, const as_policy_scan& scan_policy,
+                    uint32_t buffer_size, uint64_t max_records, as_error& error);
+    };
+}
+#endif /* end of __SCAN_ITERATOR_H__ */
@@ -0,0 +1,63 @@
+#ifndef __SCAN_JOB_H__
+#define __SCAN_JOB_H__
+
+#include "hphp/runtime/ext/extension.h"
+#include "hphp/runtime/base/execution-context.h"
+#include "hphp/runtime/vm/native-data.h"
+
+extern "C" {
+#include "aerospike/aerospike.h"
+#include "aerospike/aerospike_scan.h"
+#include "aerospike/as_status.h"
+#include "aerospike/as_error.h"
+#include "aerospike/as_policy.h"
+}
+
+namespace HPHP {
+    const StaticString s_AerospikeScanJob("AerospikeScanJob");
+
+    extern Array as_scan_info_to_php_array(const as_scan_info& scan_info);
+
+    /*
+     ************************************************************************************
+     * AerospikeScanJob class, the native data of the PHP AerospikeScanJob
+     * class returned by Aerospike::scanJob(). It is a handle on a background
+     * scan started by Aerospike::scanApply(), which returns as soon as the
+     * scan is started. Nothing blocks the request thread unless wait() is
+     * called.
+     ************************************************************************************
+     * Methods:
+     ************************************************************************************
+     * 1. Use init() to bind the job to a scan id of a connection.
+     * 2. Use info() to poll aerospike_scan_info() once.
+     * 3. Use wait() to poll it until the scan completes, is aborted or the
+     * timeout expires.
+     * 4. Use getErrorCode()/getErrorMessage() to get the error of the last
+     * call.
+     ************************************************************************************
+     */
+    class AerospikeScanJob {
+        private:
+            Object                              db;
+            uint64_t                            scan_id = 0;
+            as_policy_info                      info_policy;
+            bool                                is_initialized = false;
+            as_error                            error;
+
+            aerospike* get_connection(as_error& error) const;
+
+        public:
+            AerospikeScanJob();
+            AerospikeScanJob(const AerospikeScanJob&) = delete;
+            AerospikeScanJob& operator=(const AerospikeScanJob&) = delete;
+
+            void init(const Object& db, uint64_t scan_id,
+                    const as_policy_info& info_policy);
+            int64_t getId() const { return (int64_t) scan_id; }
+            as_status info(as_scan_info& scan_info);
+            as_status wait(int64_t timeout_ms, int64_t interval_ms);
+            as_status getErrorCode() const { return error.code; }
+            String getErrorMessage() const;
+    };
+}
+#endif /* end of __SCAN_JOB_H__ */
@@ -12,9 +12,19 @@ extern "C" {
 #include "aerospike/as_arraylist.h"
 #include "aerospike/as_scan.h"
 #include "aerospike/as_query.h"
+#include "aerospike/aerospike.h"
+#include "aerospike/aerospike_scan.h"
+#include "aerospike/as_cluster.h"
 }
 
+#include "policy.h"
+
 namespace HPHP {
+    const StaticString s_begin("begin");
+    const StaticString s_end("end");
+    const StaticString s_nodes("nodes");
+    const StaticString s_nodes_done("nodes_done");
+    const StaticString s_complete("complete");
 
     /*
      *******************************************************************************************
@@ -51,13 +61,41 @@ namespace HPHP {
      ************************************************************************************
      * Structure declaration for foreach_callback_user_udata.
      * Holds the 'function' to be populated by the callback, and 'error' to be
-     * populated in case of errors.
+     * populated in case of errors. When chunk_size is set, the records are
+     * gathered into 'chunk' and passed to the function chunk_size at a time.
+     * 'stopped' is set once the function returned false, 'limit_reached' once
+     * max_records records were passed to it, if set. The callback only
+     * runs on the request thread, the records of concurrent scans and of
+     * queries being handed over to it by a RecordStream.
      ************************************************************************************
      */
     typedef struct __foreach_callback_user_udata {
         const Variant& function;
         as_error& error;
+        uint32_t chunk_size = 0;
+        Array chunk;
+        bool stopped = false;
+        uint64_t max_records = 0;
+        uint64_t n_records = 0;
+        bool limit_reached = false;
         __foreach_callback_user_udata(const Variant &init_data, as_error& init_error) : function(init_data), error(init_error) {}
     } foreach_callback_user_udata;
+
+    extern void finish_scan_query(foreach_callback_user_udata& udata);
+
+    /*
+     *******************************************************************************************
+     * Declaration of functions for the scans restricted to a partition range
+     * and resumed from a cursor
+     *******************************************************************************************
+     */
+    extern as_status parse_scan_cursor(const Variant& cursor, const as_scan *scan_p,
+            scan_partition_range& range, Array& nodes_done, Array& nodes, as_error& error);
+    extern Array create_scan_cursor(const as_scan *scan_p, const scan_partition_range& range,
+            const Array& nodes_done, const Array& nodes, bool complete);
+    extern as_status scan_partitions(aerospike *as_p, const as_policy_scan *scan_policy_p,
+            as_scan *scan_p, const scan_partition_range& range, Array& nodes_done,
+            Array& nodes, bool& complete, foreach_callback_user_udata& udata,
+            as_error& error);
 } //namespace HPHP
 #endif /* end of __SCAN_OPERATION_H__ */
@@ -0,0 +1,450 @@
+#include "async_operations.h"
+#include "conversions.h"
+#include "ext_aerospike.h"
+
+#include <chrono>
+
+extern "C" {
+#include "aerospike/as_msgpack.h"
+#include "aerospike/as_serializer.h"
+}
+
+namespace HPHP {
+
+    /*
+     * Process wide pool of workers of the *Async() methods
+     */
+    AsyncCommandPool async_command_pool;
+
+    /*
+     *******************************************************************************************
+     * Constructor for AerospikeAsyncEvent.
+     *
+     * @param as_ref_p      aerospike_ref of the connection the command is
+     *                      executed on. May be NULL if the event is to be
+     *                      dispatched with an error.
+     *******************************************************************************************
+     */
+    AerospikeAsyncEvent::AerospikeAsyncEvent(aerospike_ref *as_ref_p) : as_ref_p(as_ref_p)
+    {
+        as_error_init(&error);
+    }
+
+    /*
+     *******************************************************************************************
+     * Destructor for AerospikeAsyncEvent. May run on a worker thread.
+     *******************************************************************************************
+     */
+    AerospikeAsyncEvent::~AerospikeAsyncEvent()
+    {
+        if (key_initialized) {
+            as_key_destroy(&key);
+        }
+    }
+
+    /*
+     *******************************************************************************************
+     * Takes a copy of the key which owns its primary key, so that the PHP
+     * key array or AerospikeKey object it refers to may go away while the
+     * command is pending.
+     *
+     * @param source        as_key reference of the command's key
+     *******************************************************************************************
+     */
+    void AerospikeAsyncEvent::set_key(const as_key& source)
+    {
+        as_key_to_owned_as_key(source, key);
+        key_initialized = true;
+    }
+
+    /*
+     *******************************************************************************************
+     * Queues the command on the AsyncCommandPool, or finishes the event at
+     * once if error holds the failure of the conversion of the arguments.
+     *
+     * @param error         as_error reference holding the result of the
+     *                      preparation of the command
+     *******************************************************************************************
+     */
+    void AerospikeAsyncEvent::dispatch(const as_error& error)
+    {
+        as_error_copy(&this->error, &error);
+
+        if (this->error.code == AEROSPIKE_OK) {
+            as_ref_p->ref_async_commands++;
+            if (async_command_pool.enqueue([this] { run(); })) {
+                return;
+            }
+            as_ref_p->ref_async_commands--;
+            as_error_update(&this->error, AEROSPIKE_ERR_CLIENT,
+                    "Async command pool is shut down");
+        }
+        markAsFinished();
+    }
+
+    /*
+     *******************************************************************************************
+     * Executes the command on the calling worker thread. The event must not
+     * be used once it is marked as finished.
+     *******************************************************************************************
+     */
+    void AerospikeAsyncEvent::run()
+    {
+        execute();
+        as_ref_p->ref_async_commands--;
+        markAsFinished();
+    }
+
+    /*
+     *******************************************************************************************
+     * Builds the result of the Awaitable on the request thread:
+     * array("status" => int, "error" => string [, result of the method ])
+     *******************************************************************************************
+     */
+    void AerospikeAsyncEvent::unserialize(Cell& result)
+    {
+        Array php_result = Array::Create();
+
+        if (error.code == AEROSPIKE_OK) {
+            build_result(php_result);
+        }
+        php_result.set(s_status, (int64_t) error.code);
+        php_result.set(s_error, error.code == AEROSPIKE_OK ?
+                empty_string() : String(error.message, CopyString));
+
+        cellDup(*Variant(php_result).asCell(), result);
+    }
+
+    /*
+     *******************************************************************************************
+     * Definitions of the events of the individual *Async() methods.
+     *******************************************************************************************
+     */
+    AsyncGetEvent::~AsyncGetEvent()
+    {
+        if (rec_p) {
+            as_record_destroy(rec_p);
+        }
+    }
+
+    void AsyncGetEvent::execute()
+    {
+        if (has_filter) {
+            const char *filter[filter_bins.size() + 1];
+            uint32_t filter_count = 0;
+            for (const std::string& bin : filter_bins) {
+                filter[filter_count++] = bin.c_str();
+            }
+            filter[filter_count] = NULL;
+            aerospike_key_select(as_ref_p->as_p, &error, &read_policy, &key,
+                    filter, &rec_p);
+        } else {
+            aerospike_key_get(as_ref_p->as_p, &error, &read_policy, &key, &rec_p);
+        }
+    }
+
+    void AsyncGetEvent::build_result(Array& php_result)
+    {
+        Array php_rec = Array::Create();
+        as_record_to_php_record(rec_p, &key, php_rec, &read_policy.key, error);
+        php_result.set(s_record, php_rec);
+    }
+
+    AsyncPutEvent::~AsyncPutEvent()
+    {
+        if (rec_initialized) {
+            as_record_destroy(&rec);
+        }
+    }
+
+    void AsyncPutEvent::execute()
+    {
+        aerospike_key_put(as_ref_p->as_p, &error, &write_policy, &key, &rec);
+    }
+
+    AsyncOperateEvent::~AsyncOperateEvent()
+    {
+        if (operations_initialized) {
+            as_operations_destroy(&operations);
+        }
+        if (rec_p) {
+            as_record_destroy(rec_p);
+        }
+    }
+
+    void AsyncOperateEvent::execute()
+    {
+        aerospike_key_operate(as_ref_p->as_p, &error, &operate_policy, &key,
+                &operations, &rec_p);
+    }
+
+    void AsyncOperateEvent::build_result(Array& php_result)
+    {
+        Array php_rec = Array::Create();
+        if (rec_p) {
+            bins_to_php_bins(rec_p, php_rec, error);
+        }
+        php_result.set(s_returned, php_rec);
+    }
+
+    void AsyncRemoveEvent::execute()
+    {
+        aerospike_key_remove(as_ref_p->as_p, &error, &remove_policy, &key);
+    }
+
+    AsyncExistsEvent::~AsyncExistsEvent()
+    {
+        if (rec_p) {
+            as_record_destroy(rec_p);
+        }
+    }
+
+    void AsyncExistsEvent::execute()
+    {
+        aerospike_key_exists(as_ref_p->as_p, &error, &read_policy, &key, &rec_p);
+    }
+
+    void AsyncExistsEvent::build_result(Array& php_result)
+    {
+        Array php_metadata = Array::Create();
+        metadata_to_php_metadata(rec_p, php_metadata, error);
+        php_result.set(s_metadata, php_metadata);
+    }
+
+    /*
+     *******************************************************************************************
+     * Returns a heap allocated copy of value_p which owns all of its data.
+     * The values produced by the conversions refer to the PHP strings they
+     * were converted from and live in a StaticPoolManager, neither of which
+     * may be used once the request thread moves on. Buffers owned by an
+     * as_bytes (packed lists/maps, serialized values) are moved instead of
+     * copied.
+     *
+     * @param value_p       The as_val to be copied.
+     * @return the copy, or NULL if the copy failed.
+     *******************************************************************************************
+     */
+    as_val* as_val_to_owned_as_val(as_val *value_p)
+    {
+        if (!value_p) {
+            return NULL;
+        }
+
+        switch (as_val_type(value_p)) {
+            case AS_NIL:
+                return value_p;
+            case AS_INTEGER:
+                return (as_val *) as_integer_new(as_integer_get((as_integer *) value_p));
+            case AS_DOUBLE:
+                return (as_val *) as_double_new(as_double_get((as_double *) value_p));
+            case AS_BOOLEAN:
+                return (as_val *) as_boolean_new(as_boolean_get((as_boolean *) value_p));
+            case AS_STRING:
+                {
+                    /*
+                     * Copied by length, as a string bin may hold NULs
+                     */
+                    as_string *string_p = (as_string *) value_p;
+                    size_t len = as_string_len(string_p);
+                    char *str_p = (char *) malloc(len + 1);
+                    if (!str_p) {
+                        return NULL;
+                    }
+                    memcpy(str_p, as_string_get(string_p), len);
+                    str_p[len] = '\0';
+                    as_string *owned_p = as_string_new_wlen(str_p, len, true);
+                    if (!owned_p) {
+                        free(str_p);
+                    }
+                    return (as_val *) owned_p;
+                }
+            case AS_BYTES:
+                {
+                    as_bytes *bytes_p = (as_bytes *) value_p;
+                    uint8_t *buffer_p = bytes_p->value;
+                    if (!bytes_p->free) {
+                        buffer_p = (uint8_t *) malloc(bytes_p->size ? bytes_p->size : 1);
+                        if (!buffer_p) {
+                            return NULL;
+                        }
+                        memcpy(buffer_p, bytes_p->value, bytes_p->size);
+                    }
+                    as_bytes *owned_p = as_bytes_new_wrap(buffer_p, bytes_p->size, true);
+                    if (!owned_p) {
+                        if (buffer_p != bytes_p->value) {
+                            free(buffer_p);
+                        }
+                        return NULL;
+                    }
+                    as_bytes_set_type(owned_p, as_bytes_get_type(bytes_p));
+                    bytes_p->free = false;
+                    return (as_val *) owned_p;
+                }
+            default:
+                {
+                    /*
+                     * Lists and maps: a msgpack round trip yields a deep copy
+                     */
+                    as_serializer   serializer;
+                    as_buffer       buffer;
+                    as_val          *owned_p = NULL;
+
+                    as_msgpack_init(&serializer);
+                    as_buffer_init(&buffer);
+                    if (0 == as_serializer_serialize(&serializer, value_p, &buffer)) {
+                        as_serializer_deserialize(&serializer, &buffer, &owned_p);
+                    }
+                    as_buffer_destroy(&buffer);
+                    as_serializer_destroy(&serializer);
+                    return owned_p;
+                }
+        }
+    }
+
+    /*
+     *******************************************************************************************
+     * Replaces the values of the bins of a converted record by owned copies,
+     * see as_val_to_owned_as_val(). To be called on the request thread while
+     * the StaticPoolManager of the conversion is alive.
+     *
+     * @param rec           as_record reference to be updated
+     * @param error         as_error reference to be populated by this function
+     *                      in case of error
+     * @return AEROSPIKE_OK if success. Otherwise AEROSPIKE_ERR_*.
+     *******************************************************************************************
+     */
+    as_status own_record_values(as_record& rec, as_error& error)
+    {
+        as_error_reset(&error);
+
+        for (uint16_t iter = 0; iter < rec.bins.size; iter++) {
+            as_bin *bin_p = &rec.bins.entries[iter];
+            if (!bin_p->valuep) {
+                continue;
+            }
+            as_val *owned_p = as_val_to_owned_as_val((as_val *) bin_p->valuep);
+            if (!owned_p) {
+                return as_error_update(&error, AEROSPIKE_ERR_CLIENT,
+                        "Unable to copy the value of bin %s", bin_p->name);
+            }
+            bin_p->valuep = (as_bin_value *) owned_p;
+        }
+        return error.code;
+    }
+
+    /*
+     *******************************************************************************************
+     * Replaces the values of converted operations by owned copies, see
+     * as_val_to_owned_as_val(). To be called on the request thread while the
+     * StaticPoolManager of the conversion is alive.
+     *
+     * @param operations    as_operations reference to be updated
+     * @param error         as_error reference to be populated by this function
+     *                      in case of error
+     * @return AEROSPIKE_OK if success. Otherwise AEROSPIKE_ERR_*.
+     *******************************************************************************************
+     */
+    as_status own_operations_values(as_operations& operations, as_error& error)
+    {
+        as_error_reset(&error);
+
+        for (uint16_t iter = 0; iter < operations.binops.size; iter++) {
+            as_bin *bin_p = &operations.binops.entries[iter].bin;
+            if (!bin_p->valuep) {
+                continue;
+            }
+            as_val *owned_p = as_val_to_owned_as_val((as_val *) bin_p->valuep);
+            if (!owned_p) {
+                return as_error_update(&error, AEROSPIKE_ERR_CLIENT,
+                        "Unable to copy the value of operation on bin %s", bin_p->name);
+            }
+            bin_p->valuep = (as_bin_value *) owned_p;
+        }
+        return error.code;
+    }
+
+    /*
+     *******************************************************************************************
+     * Queues a job for execution on a worker thread. The workers are
+     * started by the first call.
+     *
+     * @param job           The job to be executed.
+     * @return true if queued. false if the pool is shut down.
+     *******************************************************************************************
+     */
+    bool AsyncCommandPool::enqueue(std::function<void()> job)
+    {
+        std::lock_guard<std::mutex> guard(lock);
+
+        if (stopping) {
+            return false;
+        }
+        if (workers.empty()) {
+            for (uint32_t iter = 0; iter < ASYNC_COMMAND_WORKERS; iter++) {
+                workers.emplace_back(&AsyncCommandPool::worker_loop, this);
+            }
+        }
+        queue.push_back(std::move(job));
+        cond.notify_one();
+        return true;
+    }
+
+    /*
+     *******************************************************************************************
+     * Body of the worker threads, runs the queued jobs until the pool is
+     * shut down and the queue is drained.
+     *******************************************************************************************
+     */
+    void AsyncCommandPool::worker_loop()
+    {
+        while (true) {
+            std::function<void()> job;
+            {
+                std::unique_lock<std::mutex> guard(lock);
+                cond.wait(guard, [this] { return stopping || !queue.empty(); });
+                if (queue.empty()) {
+                    return;
+                }
+                job = std::move(queue.front());
+                queue.pop_front();
+            }
+            job();
+        }
+    }
+
+    /*
+     *******************************************************************************************
+     * Stops accepting events, runs the queued ones and joins the workers.
+     * To be called at module shutdown, before the connections are closed.
+     *******************************************************************************************
+     */
+    void AsyncCommandPool::shutdown()
+    {
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            stopping = true;
+        }
+        cond.notify_all();
+
+        for (std::thread& worker : workers) {
+            worker.join();
+        }
+        workers.clear();
+    }
+
+    /*
+     *******************************************************************************************
+     * Waits until the commands of the *Async() methods pending on the
+     * connection have completed. To be called before closing a connection
+     * that is not persistent.
+     *
+     * @param as_ref_p      aerospike_ref of the connection.
+     *******************************************************************************************
+     */
+    void wait_for_async_commands(aerospike_ref *as_ref_p)
+    {
+        while (as_ref_p && as_ref_p->ref_async_commands.load() > 0) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+    }
+} // namespace HPHP
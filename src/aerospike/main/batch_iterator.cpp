@@ -0,0 +1,288 @@
+#include "batch_iterator.h"
+#include "ext_aerospike.h"
+#include "async_operations.h"
+#include "conversions.h"
+#include "helper.h"
+
+namespace HPHP {
+
+    /*
+     *******************************************************************************************
+     * Constructor for AerospikeBatchIterator.
+     *******************************************************************************************
+     */
+    AerospikeBatchIterator::AerospikeBatchIterator()
+    {
+        as_error_init(&error);
+    }
+
+    /*
+     *******************************************************************************************
+     * Destructor for AerospikeBatchIterator, waits for the chunks in flight
+     * and destroys all the chunks held.
+     *******************************************************************************************
+     */
+    AerospikeBatchIterator::~AerospikeBatchIterator()
+    {
+        std::unique_lock<std::mutex> guard(lock);
+        cond.wait(guard, [this] { return in_flight == 0; });
+
+        for (batch_iterator_chunk *completed_p : completed) {
+            destroy_chunk(completed_p);
+        }
+        completed.clear();
+        destroy_chunk(chunk_p);
+        chunk_p = NULL;
+    }
+
+    void AerospikeBatchIterator::destroy_chunk(batch_iterator_chunk *chunk_p)
+    {
+        if (chunk_p) {
+            if (chunk_p->records_p) {
+                as_batch_read_destroy(chunk_p->records_p);
+            }
+            delete chunk_p;
+        }
+    }
+
+    /*
+     *******************************************************************************************
+     * Validates the keys and the filter bins, and starts reading the first
+     * chunks.
+     *
+     * @param db                    The Aerospike object, kept alive by the
+     *                              iterator.
+     * @param as_ref_p              aerospike_ref of the connection of db.
+     * @param php_keys              The PHP keys array.
+     * @param php_filter_bins       The optional PHP filter bins array.
+     * @param batch_policy          The as_policy_batch to be used for the
+     *                              batch commands.
+     * @param error                 as_error reference to be populated by this
+     *                              method in case of error.
+     *
+     * @return AEROSPIKE_OK if SUCCESS. Otherwise AEROSPIKE_ERR_*.
+     *******************************************************************************************
+     */
+    as_status AerospikeBatchIterator::init(const Object& db, aerospike_ref *as_ref_p,
+            const Array& php_keys, const Variant& php_filter_bins,
+            const as_policy_batch& batch_policy, as_error& error)
+    {
+        as_error_reset(&error);
+
+        if (is_initialized) {
+            return as_error_update(&error, AEROSPIKE_ERR_CLIENT,
+                    "AerospikeBatchIterator is already initialized");
+        }
+
+        if (!php_filter_bins.isNull() && !php_filter_bins.isArray()) {
+            return as_error_update(&error, AEROSPIKE_ERR_PARAM,
+                    "Invalid filter bins type: Expected an array or NULL");
+        }
+
+        if (php_filter_bins.isArray()) {
+            for (ArrayIter iter(php_filter_bins.toArray()); iter; ++iter) {
+                if (!iter.second().isString()) {
+                    return as_error_update(&error, AEROSPIKE_ERR_PARAM,
+                            "Bin name in filter bins must be a string");
+                }
+                filter_bins.push_back(iter.second().toString().toCppString());
+            }
+            for (std::string& bin : filter_bins) {
+                filter_bins_p.push_back(&bin[0]);
+            }
+            has_filter = true;
+        }
+
+        this->php_keys.reserve(php_keys.size());
+        this->php_key_indexes.reserve(php_keys.size());
+        for (ArrayIter iter(php_keys); iter; ++iter) {
+            as_key key;
+            Variant php_key = iter.second();
+            if (AEROSPIKE_OK != php_key_to_as_key(php_key, key, error)) {
+                return error.code;
+            }
+            as_key_destroy(&key);
+            this->php_keys.push_back(php_key);
+            this->php_key_indexes.push_back(iter.first());
+        }
+
+        this->db = db;
+        this->as_ref_p = as_ref_p;
+        this->batch_policy = batch_policy;
+        is_initialized = true;
+
+        dispatch_chunks();
+        return error.code;
+    }
+
+    /*
+     *******************************************************************************************
+     * Converts the keys of the next chunks and queues their batch commands,
+     * until BATCH_ITERATOR_MAX_IN_FLIGHT chunks are in flight or all keys
+     * are dispatched. Stops dispatching once the connection of db was
+     * closed, since its cluster may be destroyed. Called on the request
+     * thread only.
+     *******************************************************************************************
+     */
+    void AerospikeBatchIterator::dispatch_chunks()
+    {
+        while (next_key < php_keys.size()) {
+            if (!Native::data<Aerospike>(db.get())->is_connected ||
+                    as_ref_p->ref_php_object < 1) {
+                if (error.code == AEROSPIKE_OK) {
+                    as_error_update(&error, AEROSPIKE_ERR_CLUSTER,
+                            "AerospikeBatchIterator: connection not established");
+                }
+                next_key = php_keys.size();
+                return;
+            }
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                if (in_flight + completed.size() >= BATCH_ITERATOR_MAX_IN_FLIGHT) {
+                    return;
+                }
+                in_flight++;
+            }
+
+            uint32_t chunk_size = std::min((uint32_t) BATCH_ITERATOR_CHUNK_SIZE,
+                    (uint32_t) php_keys.size() - next_key);
+            batch_iterator_chunk *new_chunk_p = new batch_iterator_chunk;
+            as_error_init(&new_chunk_p->error);
+            new_chunk_p->first_key = next_key;
+            new_chunk_p->records_p = as_batch_read_create(chunk_size);
+
+            for (uint32_t iter = 0; iter < chunk_size; iter++) {
+                as_key key;
+                as_error key_error;
+                as_error_init(&key_error);
+                as_batch_read_record *record_p = as_batch_read_reserve(new_chunk_p->records_p);
+                /* Validated by init() */
+                php_key_to_as_key(php_keys[next_key + iter], key, key_error);
+                as_key_to_owned_as_key(key, record_p->key);
+                as_key_destroy(&key);
+                if (has_filter) {
+                    record_p->bin_names = filter_bins_p.data();
+                    record_p->n_bin_names = filter_bins_p.size();
+                } else {
+                    record_p->read_all_bins = true;
+                }
+            }
+            next_key += chunk_size;
+
+            as_ref_p->ref_async_commands++;
+            auto read_chunk = [this, new_chunk_p] {
+                aerospike_batch_read(as_ref_p->as_p, &new_chunk_p->error,
+                        &batch_policy, new_chunk_p->records_p);
+                as_ref_p->ref_async_commands--;
+
+                std::lock_guard<std::mutex> guard(lock);
+                completed.push_back(new_chunk_p);
+                in_flight--;
+                cond.notify_all();
+            };
+            if (!async_command_pool.enqueue(read_chunk)) {
+                read_chunk();
+            }
+        }
+    }
+
+    /*
+     *******************************************************************************************
+     * Replaces the current chunk by the next completed one, waiting for it if
+     * needed.
+     *
+     * @return true if there is a next chunk. Otherwise false.
+     *******************************************************************************************
+     */
+    bool AerospikeBatchIterator::fetch_chunk()
+    {
+        destroy_chunk(chunk_p);
+        chunk_p = NULL;
+        position = 0;
+
+        dispatch_chunks();
+
+        std::unique_lock<std::mutex> guard(lock);
+        cond.wait(guard, [this] { return !completed.empty() || in_flight == 0; });
+        if (completed.empty()) {
+            return false;
+        }
+        chunk_p = completed.front();
+        completed.pop_front();
+        guard.unlock();
+
+        if (chunk_p->error.code != AEROSPIKE_OK && error.code == AEROSPIKE_OK) {
+            as_error_copy(&error, &chunk_p->error);
+        }
+
+        /* Reads ahead while the request thread works on this chunk */
+        dispatch_chunks();
+        return true;
+    }
+
+    bool AerospikeBatchIterator::valid()
+    {
+        if (!is_initialized) {
+            return false;
+        }
+        while (!chunk_p || position >= chunk_p->records_p->list.size) {
+            if (!fetch_chunk()) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    Variant AerospikeBatchIterator::current()
+    {
+        if (!valid()) {
+            return init_null();
+        }
+
+        as_batch_read_record *record_p = (as_batch_read_record *)
+            as_vector_get(&chunk_p->records_p->list, position);
+        if (chunk_p->error.code != AEROSPIKE_OK || record_p->result != AEROSPIKE_OK) {
+            return init_null();
+        }
+
+        Array php_rec = Array::Create();
+        as_error conversion_error;
+        as_error_init(&conversion_error);
+        if (AEROSPIKE_OK != as_record_to_php_record(&record_p->record, &record_p->key,
+                    php_rec, NULL, conversion_error)) {
+            if (error.code == AEROSPIKE_OK) {
+                as_error_copy(&error, &conversion_error);
+            }
+            return init_null();
+        }
+        return php_rec;
+    }
+
+    Variant AerospikeBatchIterator::key()
+    {
+        if (!valid()) {
+            return init_null();
+        }
+        return php_key_indexes[chunk_p->first_key + position];
+    }
+
+    void AerospikeBatchIterator::next()
+    {
+        if (chunk_p) {
+            position++;
+        }
+    }
+
+    /*
+     *******************************************************************************************
+     * Returns the message of the first error met, an empty string if none.
+     *******************************************************************************************
+     */
+    String AerospikeBatchIterator::getErrorMessage() const
+    {
+        if (error.code == AEROSPIKE_OK) {
+            return empty_string();
+        }
+        return String(error.message, CopyString);
+    }
+} // namespace HPHP
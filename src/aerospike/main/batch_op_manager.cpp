@@ -1,6 +1,15 @@
 #include "batch_op_manager.h"
 #include "conversions.h"
 #include "helper.h"
+#include "async_operations.h"
+#include "ext_aerospike.h"
+
+#include "hphp/runtime/base/packed-array.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
 
 namespace HPHP {
 
@@ -22,17 +31,17 @@ namespace HPHP {
      */
     BatchOpManager::BatchOpManager(const Array& php_keys)
     {
-        uint16_t batch_iter = 0;
+        uint32_t batch_iter = 0;
         std::exception e;
 
         as_batch_init(&this->batch, php_keys.size());
         for (ArrayIter iter(php_keys); iter; ++iter) {
             Variant php_key = iter.second();
-            if (php_key.isArray()) {
+            if (php_key.isArray() || php_key.isObject()) {
                 as_key *key_p = as_batch_keyat(&this->batch, batch_iter);
                 as_error error;
                 as_error_init(&error);
-                if (AEROSPIKE_OK != php_key_to_as_key(php_key.toArray(),
+                if (AEROSPIKE_OK != php_key_to_as_key(php_key,
                             *key_p, error)) {
                     throw e;
                 }
@@ -55,7 +64,7 @@ namespace HPHP {
      *                              to be populated with the current value
      *                              (inner_meta_array) using the key_p as the
      *                              current key.
-     * @param inner_meta_array      PHP Array reference to the inner_meta_array
+     * @param inner_meta_array      PHP Variant reference to the inner_meta_array
      *                              which is the current value to be populated
      *                              within the outer_meta_array.
      * @param error                 as_error reference to be populated by this
@@ -63,7 +72,7 @@ namespace HPHP {
      *******************************************************************************************
      */
     void BatchOpManager::populate_result_for_get_exists_many(as_key *key_p,
-            Array& outer_meta_array, Array& inner_meta_array,
+            Array& outer_meta_array, const Variant& inner_meta_array,
             as_error& error)
     {
         as_error_reset(&error);
@@ -74,7 +83,8 @@ namespace HPHP {
         } else {
             switch (((as_val*)(key_p->valuep))->type) {
                 case AS_STRING:
-                    outer_meta_array.set(String((char *) key_p->value.string.value),
+                    outer_meta_array.set(String((char *) key_p->value.string.value,
+                                as_string_len((as_string *) &key_p->value.string), CopyString),
                             inner_meta_array);
                     break;
                 case AS_INTEGER:
@@ -89,6 +99,217 @@ namespace HPHP {
         }
     }
 
+    /*
+     *******************************************************************************************
+     * Private member function that creates the result of a positional batch
+     * read: a packed array reserved for, and holding value for, each key.
+     *
+     * @param size                  The no. of keys of the batch.
+     * @param value                 The initial value of each key, NULL by
+     *                              default.
+     *
+     * @return the result array.
+     *******************************************************************************************
+     */
+    Array BatchOpManager::create_positional_result(uint32_t size,
+            const Variant& value)
+    {
+        Array result = Array::attach(PackedArray::MakeReserve(size));
+        for (uint32_t i = 0; i < size; i++) {
+            result.append(value);
+        }
+        return result;
+    }
+
+    /*
+     *******************************************************************************************
+     * Private member function that tells whether the batch is read through
+     * execute_chunks(): when it is split into sub-batches, or when the keys
+     * which failed are to be read again.
+     *******************************************************************************************
+     */
+    bool BatchOpManager::is_chunked(const batch_chunking& chunking) const
+    {
+        uint32_t keys_size = this->batch.keys.size;
+
+        return keys_size && ((chunking.chunk_size && keys_size > chunking.chunk_size) ||
+                chunking.failed_key_retries);
+    }
+
+    /*
+     *******************************************************************************************
+     * Private member function that returns the chunking to be given to
+     * execute_chunks(): chunking itself if the batch is split into
+     * sub-batches, otherwise a single sub-batch of all the keys.
+     *******************************************************************************************
+     */
+    batch_chunking BatchOpManager::whole_batch_chunking(const batch_chunking& chunking) const
+    {
+        batch_chunking      batch_chunks = chunking;
+        uint32_t            keys_size = this->batch.keys.size;
+
+        if (!chunking.chunk_size || keys_size <= chunking.chunk_size) {
+            batch_chunks.chunk_size = std::max(1u, keys_size);
+            batch_chunks.max_in_flight = 1;
+            batch_chunks.retries = 0;
+        }
+        return batch_chunks;
+    }
+
+    /*
+     *******************************************************************************************
+     * Private member function that sets error if keys of the batch failed,
+     * unless it is already set.
+     *
+     * @param udata                 The userdata populated by the batch read.
+     * @param error                 as_error reference to be populated by this
+     *                              method with the status of the first key
+     *                              which failed.
+     *
+     * @return AEROSPIKE_OK if no key failed. Otherwise AEROSPIKE_ERR_*.
+     *******************************************************************************************
+     */
+    as_status BatchOpManager::set_failed_keys_error(const batch_read_udata& udata,
+            as_error& error)
+    {
+        if (AEROSPIKE_OK == error.code && udata.failed) {
+            as_error_update(&error, udata.failed_status,
+                    "Failed to read %u key(s) of the batch", udata.failed);
+        }
+        return error.code;
+    }
+
+    /*
+     *******************************************************************************************
+     * Private member function that populates the result and the status of a
+     * key of a batch read within udata, at the position of the key if the
+     * results are positional, using the key_p as the key otherwise.
+     *
+     * @param key_p                 as_key pointer of the key.
+     * @param position              The position of the key in the batch.
+     * @param value                 The result of the key.
+     * @param status                The status of the key.
+     * @param udata                 The userdata to be populated.
+     *******************************************************************************************
+     */
+    void BatchOpManager::populate_result(as_key *key_p, uint32_t position,
+            const Variant& value, as_status status, batch_read_udata *udata)
+    {
+        if (status != AEROSPIKE_OK && status != AEROSPIKE_ERR_RECORD_NOT_FOUND &&
+                udata->failed++ == 0) {
+            udata->failed_status = status;
+        }
+
+        if (udata->positional) {
+            udata->data.set((int64_t) position, value);
+            udata->statuses.set((int64_t) position, (int64_t) status);
+        } else {
+            BatchOpManager::populate_result_for_get_exists_many(key_p,
+                    udata->data, value, udata->error);
+            if (AEROSPIKE_OK == udata->error.code) {
+                BatchOpManager::populate_result_for_get_exists_many(key_p,
+                        udata->statuses, (int64_t) status, udata->error);
+            }
+        }
+    }
+
+    /*
+     *******************************************************************************************
+     * Private member function that converts the metadata of a key of a batch
+     * exists into udata. A key which failed gets a NULL result and its
+     * status, and is counted within udata.
+     *
+     * @param result                The status of the key in the batch results.
+     * @param record_p              as_record pointer holding the metadata, if
+     *                              result is AEROSPIKE_OK.
+     * @param key_p                 as_key pointer of the key.
+     * @param position              The position of the key in the batch.
+     * @param udata                 The userdata to be populated with the PHP
+     *                              equivalent of the metadata.
+     * @return true if SUCCESS else false.
+     *******************************************************************************************
+     */
+    bool BatchOpManager::populate_exists_result(as_status result, as_record *record_p,
+            as_key *key_p, uint32_t position, batch_read_udata *udata)
+    {
+        Array metadata;
+        if (result == AEROSPIKE_OK) {
+            metadata = Array::Create();
+            metadata_to_php_metadata(record_p, metadata, udata->error);
+            if (AEROSPIKE_OK != udata->error.code) {
+                return false;
+            }
+        }
+        populate_result(key_p, position, metadata, result, udata);
+        return AEROSPIKE_OK == udata->error.code;
+    }
+
+    /*
+     *******************************************************************************************
+     * Private member function that flags a key of a batch exists as existing
+     * within udata, by setting its bit within udata.bitmap_p if set, its
+     * boolean within udata.data otherwise. No metadata is converted. Only a
+     * key which failed gets a status, under its position in udata.statuses,
+     * and is counted within udata.
+     *
+     * @param result                The status of the key in the batch results.
+     * @param record_p              as_record pointer holding the metadata,
+     *                              unused.
+     * @param key_p                 as_key pointer of the key, unused.
+     * @param position              The position of the key in the batch.
+     * @param udata                 The userdata to be populated.
+     * @return true.
+     *******************************************************************************************
+     */
+    bool BatchOpManager::populate_exists_flag(as_status result, as_record *record_p,
+            as_key *key_p, uint32_t position, batch_read_udata *udata)
+    {
+        if (result == AEROSPIKE_OK) {
+            if (udata->bitmap_p) {
+                udata->bitmap_p[position >> 3] |= (unsigned char) (1 << (position & 7));
+            } else {
+                udata->data.set((int64_t) position, true);
+            }
+        } else if (result != AEROSPIKE_ERR_RECORD_NOT_FOUND) {
+            if (udata->failed++ == 0) {
+                udata->failed_status = result;
+            }
+            udata->statuses.set((int64_t) position, (int64_t) result);
+        }
+        return true;
+    }
+
+    /*
+     *******************************************************************************************
+     * Private member function that converts the record of a key of a batch
+     * get into udata. A key which failed gets a NULL result and its status,
+     * and is counted within udata.
+     *
+     * @param result                The status of the key in the batch results.
+     * @param record_p              as_record pointer holding the record, if
+     *                              result is AEROSPIKE_OK.
+     * @param key_p                 as_key pointer of the key.
+     * @param position              The position of the key in the batch.
+     * @param udata                 The userdata to be populated with the PHP
+     *                              equivalent of the record.
+     * @return true if SUCCESS else false.
+     *******************************************************************************************
+     */
+    bool BatchOpManager::populate_get_result(as_status result, as_record *record_p,
+            as_key *key_p, uint32_t position, batch_read_udata *udata)
+    {
+        Array record;
+        if (result == AEROSPIKE_OK) {
+            record = Array::Create();
+            as_record_to_php_record(record_p, key_p, record, NULL, udata->error);
+            if (AEROSPIKE_OK != udata->error.code) {
+                return false;
+            }
+        }
+        populate_result(key_p, position, record, result, udata);
+        return AEROSPIKE_OK == udata->error.code;
+    }
+
     /*
      *******************************************************************************************
      * Private member function that is registered as the callback
@@ -104,30 +325,40 @@ namespace HPHP {
     bool BatchOpManager::batch_exists_cb(const as_batch_read* results,
             uint32_t n, void* udata)
     {
-        foreach_callback_udata *exists_cb_udata = (foreach_callback_udata *) udata;
-        uint16_t i = 0;
+        batch_read_udata *exists_cb_udata = (batch_read_udata *) udata;
+        uint32_t i = 0;
         as_error_reset(&exists_cb_udata->error);
 
         for (i = 0; i < n; i++) {
-            if (results[i].result != AEROSPIKE_OK &&
-                    results[i].result != AEROSPIKE_ERR_RECORD_NOT_FOUND) {
+            if (!populate_exists_result(results[i].result,
+                        (as_record *) &results[i].record, (as_key *) results[i].key,
+                        i, exists_cb_udata)) {
                 return false;
             }
-
-            Array metadata;
-            if (results[i].result == AEROSPIKE_OK) {
-                metadata = Array::Create();
-                metadata_to_php_metadata(&results[i].record,
-                        metadata, exists_cb_udata->error);
-                if (AEROSPIKE_OK != exists_cb_udata->error.code) {
-                    return false;
-                }
-            }
-            BatchOpManager::populate_result_for_get_exists_many((as_key *) results[i].key,
-                    exists_cb_udata->data, metadata, exists_cb_udata->error);
         }
-        if (AEROSPIKE_OK != exists_cb_udata->error.code) {
-            return false;
+        return true;
+    }
+
+    /*
+     *******************************************************************************************
+     * Private member function that is registered as the callback
+     * for batch exists returning a flag per key, invoked by the C client.
+     *
+     * @param results               as_batch_read pointer that holds the batch results.
+     * @param n                     number of keys in the batch results.
+     * @param udata                 The userdata passed to this callback, to be
+     *                              populated with the flag of each key.
+     * @return true.
+     *******************************************************************************************
+     */
+    bool BatchOpManager::batch_exists_flags_cb(const as_batch_read* results,
+            uint32_t n, void* udata)
+    {
+        batch_read_udata *exists_cb_udata = (batch_read_udata *) udata;
+
+        for (uint32_t i = 0; i < n; i++) {
+            populate_exists_flag(results[i].result, (as_record *) &results[i].record,
+                    (as_key *) results[i].key, i, exists_cb_udata);
         }
         return true;
     }
@@ -147,35 +378,210 @@ namespace HPHP {
     bool BatchOpManager::batch_get_cb(const as_batch_read* results,
             uint32_t n, void* udata)
     {
-        foreach_callback_udata *get_cb_udata = (foreach_callback_udata *) udata;
-        uint16_t i = 0;
+        batch_read_udata *get_cb_udata = (batch_read_udata *) udata;
+        uint32_t i = 0;
         as_error_reset(&get_cb_udata->error);
 
         for (i = 0; i < n; i++) {
-            if (results[i].result != AEROSPIKE_OK &&
-                    results[i].result != AEROSPIKE_ERR_RECORD_NOT_FOUND) {
+            if (!populate_get_result(results[i].result,
+                        (as_record *) &results[i].record, (as_key *) results[i].key,
+                        i, get_cb_udata)) {
                 return false;
             }
+        }
+        return true;
+    }
+
+    /*
+     *******************************************************************************************
+     * Private member function that reads a sub-batch, reading it again up to
+     * retries times if it times out. Runs on any thread, hence touches no
+     * PHP value. The bins set by prepare_batch_read(), if any, take
+     * precedence over filter and read_bins.
+     *
+     * @param as_p                  aerospike pointer for the current batch operation.
+     * @param batch_policy          The as_policy_batch to be used for this
+     *                              operation.
+     * @param chunk                 The sub-batch to be read, populated with
+     *                              its results.
+     * @param filter                The bins to be read, NULL for read_bins.
+     * @param filter_size           The no. of bins in filter.
+     * @param read_bins             Whether to read all the bins or only the
+     *                              metadata, if filter is NULL.
+     * @param retries               The no. of times to read the sub-batch again
+     *                              on timeout.
+     *******************************************************************************************
+     */
+    void BatchOpManager::read_chunk(aerospike *as_p, as_policy_batch& batch_policy,
+            batch_read_chunk& chunk, const char **filter,
+            uint32_t filter_size, bool read_bins, uint32_t retries) const
+    {
+        for (uint32_t attempt = 0; ; attempt++) {
+            chunk.records_p = as_batch_read_create(chunk.size);
+            for (uint32_t iter = 0; iter < chunk.size; iter++) {
+                uint32_t key_iter = chunk.positions_p ?
+                    chunk.positions_p[iter] : chunk.first_key + iter;
+                as_batch_read_record *record_p = as_batch_read_reserve(chunk.records_p);
+                as_key_to_owned_as_key(this->batch.keys.entries[key_iter], record_p->key);
+                if (!this->shapes.empty()) {
+                    const batch_read_shape& shape = this->shapes[key_iter];
+                    if (shape.n_bin_names) {
+                        record_p->bin_names = (char **) &this->bin_names[shape.first_bin_name];
+                        record_p->n_bin_names = shape.n_bin_names;
+                    } else {
+                        record_p->read_all_bins = shape.read_all_bins;
+                    }
+                } else if (filter) {
+                    record_p->bin_names = (char **) filter;
+                    record_p->n_bin_names = filter_size;
+                } else {
+                    record_p->read_all_bins = read_bins;
+                }
+            }
+
+            as_error_reset(&chunk.error);
+            if (AEROSPIKE_ERR_TIMEOUT != aerospike_batch_read(as_p, &chunk.error,
+                        &batch_policy, chunk.records_p) || attempt >= retries) {
+                return;
+            }
+            as_batch_read_destroy(chunk.records_p);
+            chunk.records_p = NULL;
+        }
+    }
+
+    /*
+     *******************************************************************************************
+     * Private member function that reads the batch split into sub-batches of
+     * chunking.chunk_size keys, up to chunking.max_in_flight at a time. The
+     * keys which failed, alone or along with their whole sub-batch, are then
+     * read again up to chunking.failed_key_retries times, gathered into a
+     * single batch. Finally the result and the status of every key are
+     * converted into udata.
+     *
+     * @param as_p                  aerospike pointer for the current batch operation.
+     * @param batch_policy          The as_policy_batch to be used for this
+     *                              operation.
+     * @param chunking              How to split the batch.
+     * @param filter                The bins to be read, NULL for read_bins.
+     * @param filter_size           The no. of bins in filter.
+     * @param read_bins             Whether to read all the bins or only the
+     *                              metadata, if filter is NULL.
+     * @param populate              The function converting the result of a key.
+     * @param udata                 The userdata to be populated with the PHP
+     *                              equivalents of the batch results.
+     * @param error                 as_error reference to be populated by this
+     *                              method in case of error converting the
+     *                              results.
+     *
+     * @return AEROSPIKE_OK if SUCCESS. Otherwise AEROSPIKE_ERR_*.
+     *******************************************************************************************
+     */
+    as_status BatchOpManager::execute_chunks(aerospike *as_p,
+            as_policy_batch& batch_policy, const batch_chunking& chunking,
+            const char **filter, uint32_t filter_size, bool read_bins,
+            batch_result_populator populate, batch_read_udata& udata,
+            as_error& error)
+    {
+        uint32_t                        keys_size = this->batch.keys.size;
+        uint32_t                        chunks_size = (keys_size + chunking.chunk_size - 1) / chunking.chunk_size;
+        uint32_t                        jobs_size = std::max(1u, std::min(chunking.max_in_flight, chunks_size));
+        std::vector<batch_read_chunk>   chunks(chunks_size);
+        std::atomic<uint32_t>           next_chunk(0);
+        std::mutex                      lock;
+        std::condition_variable         cond;
+        uint32_t                        pending_jobs = jobs_size;
+        std::vector<as_batch_read_record *> results(keys_size, NULL);
+        std::vector<as_status>          statuses(keys_size, AEROSPIKE_OK);
+
+        as_error_reset(&error);
+
+        for (uint32_t iter = 0; iter < chunks_size; iter++) {
+            chunks[iter].first_key = iter * chunking.chunk_size;
+            chunks[iter].size = std::min(chunking.chunk_size, keys_size - chunks[iter].first_key);
+            as_error_init(&chunks[iter].error);
+        }
+
+        auto run_job = [&] {
+            uint32_t chunk;
+            while ((chunk = next_chunk++) < chunks_size) {
+                read_chunk(as_p, batch_policy, chunks[chunk], filter,
+                        filter_size, read_bins, chunking.retries);
+            }
+            std::lock_guard<std::mutex> guard(lock);
+            if (--pending_jobs == 0) {
+                cond.notify_one();
+            }
+        };
+
+        for (uint32_t job = 1; job < jobs_size; job++) {
+            if (!async_command_pool.enqueue([&run_job] { run_job(); })) {
+                run_job();
+            }
+        }
+        run_job();
+
+        {
+            std::unique_lock<std::mutex> guard(lock);
+            cond.wait(guard, [&] { return pending_jobs == 0; });
+        }
+
+        auto collect_results = [&](batch_read_chunk& chunk) {
+            for (uint32_t iter = 0; iter < chunk.size; iter++) {
+                uint32_t position = chunk.positions_p ?
+                    chunk.positions_p[iter] : chunk.first_key + iter;
+                if (chunk.error.code != AEROSPIKE_OK) {
+                    statuses[position] = chunk.error.code;
+                } else {
+                    results[position] = (as_batch_read_record *)
+                        as_vector_get(&chunk.records_p->list, iter);
+                    statuses[position] = results[position]->result;
+                }
+            }
+        };
+        for (batch_read_chunk& chunk : chunks) {
+            collect_results(chunk);
+        }
 
-            Array record;
-            if (results[i].result == AEROSPIKE_OK) {
-                record = Array::Create();
-                as_record_to_php_record(&results[i].record,
-                        (as_key *) results[i].key, record, NULL,
-                        get_cb_udata->error);
-                if (AEROSPIKE_OK != get_cb_udata->error.code) {
-                    return false;
+        for (uint32_t attempt = 0; attempt < chunking.failed_key_retries; attempt++) {
+            std::vector<uint32_t> positions;
+            for (uint32_t position = 0; position < keys_size; position++) {
+                if (statuses[position] != AEROSPIKE_OK &&
+                        statuses[position] != AEROSPIKE_ERR_RECORD_NOT_FOUND) {
+                    positions.push_back(position);
                 }
             }
-            BatchOpManager::populate_result_for_get_exists_many((as_key *) results[i].key,
-                    get_cb_udata->data, record, get_cb_udata->error);
+            if (positions.empty()) {
+                break;
+            }
+
+            chunks.emplace_back();
+            batch_read_chunk& retry_chunk = chunks.back();
+            retry_chunk.size = positions.size();
+            retry_chunk.positions_p = positions.data();
+            as_error_init(&retry_chunk.error);
+            read_chunk(as_p, batch_policy, retry_chunk, filter, filter_size,
+                    read_bins, 0);
+            collect_results(retry_chunk);
+            retry_chunk.positions_p = NULL;
+        }
+
+        for (uint32_t position = 0; position < keys_size; position++) {
+            if (!populate(statuses[position],
+                        results[position] ? &results[position]->record : NULL,
+                        &this->batch.keys.entries[position], position, &udata)) {
+                break;
+            }
         }
-        if (AEROSPIKE_OK != get_cb_udata->error.code) {
-            return false;
+
+        for (batch_read_chunk& chunk : chunks) {
+            if (chunk.records_p) {
+                as_batch_read_destroy(chunk.records_p);
+                chunk.records_p = NULL;
+            }
         }
-        return true;
+        return error.code;
     }
-    
+
     /*
      *******************************************************************************************
      * Public member function that is used to invoke a batch exists operation.
@@ -183,8 +589,14 @@ namespace HPHP {
      * @param as_p                  aerospike pointer for the current batch operation.
      * @param php_metadata          The return php_metadata to be populated by
      *                              collective metadata of this batch exists operation.
+     * @param php_statuses          The return php_statuses to be populated
+     *                              with the status of each key.
      * @param batch_policy          The as_policy_batch to be used for this
      *                              operation.
+     * @param positional            Whether to return a list in the order of
+     *                              the keys rather than an array keyed by the
+     *                              record keys.
+     * @param chunking              How to split the batch into sub-batches.
      * @param error                 as_error reference to be populated by this
      *                              method in case of error.
      *
@@ -192,16 +604,87 @@ namespace HPHP {
      *******************************************************************************************
      */
     as_status BatchOpManager::execute_batch_exists(aerospike *as_p,
-            Array &php_metadata, as_policy_batch& batch_policy,
-            as_error& error)
+            Array &php_metadata, Array &php_statuses, as_policy_batch& batch_policy,
+            bool positional, const batch_chunking& chunking, as_error& error)
     {
         as_error_reset(&error);
-        foreach_callback_udata udata(php_metadata, error);
-        aerospike_batch_exists(as_p, &error, &batch_policy, &this->batch,
-                (aerospike_batch_read_callback) &batch_exists_cb, &udata);
-        return error.code;
+        if (positional) {
+            php_metadata = create_positional_result(this->batch.keys.size);
+            php_statuses = create_positional_result(this->batch.keys.size);
+        }
+        batch_read_udata udata(php_metadata, php_statuses, error, positional);
+
+        if (is_chunked(chunking)) {
+            execute_chunks(as_p, batch_policy, whole_batch_chunking(chunking),
+                    NULL, 0, false, &populate_exists_result, udata, error);
+        } else {
+            aerospike_batch_exists(as_p, &error, &batch_policy, &this->batch,
+                    (aerospike_batch_read_callback) &batch_exists_cb, &udata);
+        }
+        return set_failed_keys_error(udata, error);
     }
-    
+
+    /*
+     *******************************************************************************************
+     * Public member function that is used to invoke a batch exists operation
+     * returning only whether each key exists, in the order of the keys.
+     *
+     * @param as_p                  aerospike pointer for the current batch operation.
+     * @param php_flags             The return php_flags to be populated with
+     *                              a string holding a bit per key, bit
+     *                              (i % 8) of byte (i / 8) set if the key at
+     *                              position i exists, for BATCH_EXISTS_BITMAP,
+     *                              or with a list holding a boolean per key
+     *                              for BATCH_EXISTS_BOOLS.
+     * @param php_statuses          The return php_statuses to be populated
+     *                              with the status of each key which failed,
+     *                              under its position.
+     * @param batch_policy          The as_policy_batch to be used for this
+     *                              operation.
+     * @param format                BATCH_EXISTS_BITMAP or BATCH_EXISTS_BOOLS.
+     * @param chunking              How to split the batch into sub-batches.
+     * @param error                 as_error reference to be populated by this
+     *                              method in case of error.
+     *
+     * @return AEROSPIKE_OK if SUCCESS. Otherwise AEROSPIKE_ERR_*.
+     *******************************************************************************************
+     */
+    as_status BatchOpManager::execute_batch_exists_flags(aerospike *as_p,
+            Variant &php_flags, Array &php_statuses, as_policy_batch& batch_policy,
+            int16_t format, const batch_chunking& chunking, as_error& error)
+    {
+        uint32_t            keys_size = this->batch.keys.size;
+        Array               php_bools;
+        String              php_bitmap;
+        batch_read_udata    udata(php_bools, php_statuses, error, true);
+
+        as_error_reset(&error);
+        if (format == BATCH_EXISTS_BITMAP) {
+            uint32_t bitmap_size = (keys_size + 7) / 8;
+            php_bitmap = String(bitmap_size, ReserveString);
+            udata.bitmap_p = (unsigned char *) php_bitmap.mutableData();
+            memset(udata.bitmap_p, 0, bitmap_size);
+            php_bitmap.setSize(bitmap_size);
+        } else {
+            php_bools = create_positional_result(keys_size, false);
+        }
+
+        if (is_chunked(chunking)) {
+            execute_chunks(as_p, batch_policy, whole_batch_chunking(chunking),
+                    NULL, 0, false, &populate_exists_flag, udata, error);
+        } else if (keys_size) {
+            aerospike_batch_exists(as_p, &error, &batch_policy, &this->batch,
+                    (aerospike_batch_read_callback) &batch_exists_flags_cb, &udata);
+        }
+
+        if (format == BATCH_EXISTS_BITMAP) {
+            php_flags = php_bitmap;
+        } else {
+            php_flags = php_bools;
+        }
+        return set_failed_keys_error(udata, error);
+    }
+
     /*
      *******************************************************************************************
      * Public member function that is used to invoke a batch get operation.
@@ -209,10 +692,16 @@ namespace HPHP {
      * @param as_p                  aerospike pointer for the current batch operation.
      * @param php_records           The return php_records to be populated by
      *                              collective records of this batch get operation.
+     * @param php_statuses          The return php_statuses to be populated
+     *                              with the status of each key.
      * @param php_filter_bins       The optional php filter bins array used to
      *                              select specific bins in the batch get.
      * @param batch_policy          The as_policy_batch to be used for this
      *                              operation.
+     * @param positional            Whether to return a list in the order of
+     *                              the keys rather than an array keyed by the
+     *                              record keys.
+     * @param chunking              How to split the batch into sub-batches.
      * @param error                 as_error reference to be populated by this
      *                              method in case of error.
      *
@@ -220,36 +709,159 @@ namespace HPHP {
      *******************************************************************************************
      */
     as_status BatchOpManager::execute_batch_get(aerospike *as_p,
-            Array &php_records, const Variant& php_filter_bins,
-            as_policy_batch& batch_policy,
-            as_error& error)
+            Array &php_records, Array &php_statuses, const Variant& php_filter_bins,
+            as_policy_batch& batch_policy, bool positional,
+            const batch_chunking& chunking, as_error& error)
     {
         as_error_reset(&error);
-        foreach_callback_udata udata(php_records, error);
 
         if (!php_filter_bins.isNull() && !php_filter_bins.isArray()) {
             return as_error_update(&error, AEROSPIKE_ERR_PARAM,
                     "Invalid filter bins type: Expected an array or NULL");
         }
 
-        if (php_filter_bins.isArray()) {
-            uint16_t            total_filter_count = php_filter_bins.toArray().size();
-            const char          *filter[total_filter_count];
-                    
-            if (AEROSPIKE_OK == process_filter_bins(php_filter_bins.toArray(),
-                        filter, error)) {
-                aerospike_batch_get_bins(as_p, &error, &batch_policy,
-                        &this->batch, filter, total_filter_count,
-                        (aerospike_batch_read_callback) &batch_get_cb,
-                        &udata);
-            }
+        uint16_t            total_filter_count = php_filter_bins.isArray() ?
+                                php_filter_bins.toArray().size() : 0;
+        const char          *filter[total_filter_count + 1];
+
+        if (php_filter_bins.isArray() && AEROSPIKE_OK != process_filter_bins(
+                    php_filter_bins.toArray(), filter, error)) {
+            return error.code;
+        }
+
+        if (positional) {
+            php_records = create_positional_result(this->batch.keys.size);
+            php_statuses = create_positional_result(this->batch.keys.size);
+        }
+        batch_read_udata udata(php_records, php_statuses, error, positional);
+
+        if (is_chunked(chunking)) {
+            execute_chunks(as_p, batch_policy, whole_batch_chunking(chunking),
+                    php_filter_bins.isArray() ? filter : NULL, total_filter_count,
+                    true, &populate_get_result, udata, error);
+        } else if (php_filter_bins.isArray()) {
+            aerospike_batch_get_bins(as_p, &error, &batch_policy,
+                    &this->batch, filter, total_filter_count,
+                    (aerospike_batch_read_callback) &batch_get_cb,
+                    &udata);
         } else {
             aerospike_batch_get(as_p, &error, &batch_policy, &this->batch,
                     (aerospike_batch_read_callback) &batch_get_cb, &udata);
         }
+        return set_failed_keys_error(udata, error);
+    }
+
+    /*
+     *******************************************************************************************
+     * Public member function that sets the bins to be read for each key of
+     * a batch read. Each element of php_keys_to_bins is an array("key" =>
+     * key, "bins" => array of bin names or NULL, "header_only" => bool), in
+     * the order of the keys given to the constructor. The key is read
+     * entirely if bins is NULL or missing, and only its metadata if
+     * header_only is true or bins is empty.
+     *
+     * @param php_keys_to_bins      The PHP array of keys and their bins.
+     * @param error                 as_error reference to be populated by this
+     *                              method in case of error.
+     *
+     * @return AEROSPIKE_OK if SUCCESS. Otherwise AEROSPIKE_ERR_*.
+     *******************************************************************************************
+     */
+    as_status BatchOpManager::prepare_batch_read(const Array& php_keys_to_bins,
+            as_error& error)
+    {
+        uint32_t            iter_shapes = 0;
+
+        as_error_reset(&error);
+        this->shapes.resize(php_keys_to_bins.size());
+
+        for (ArrayIter iter(php_keys_to_bins); iter; ++iter, iter_shapes++) {
+            batch_read_shape& shape = this->shapes[iter_shapes];
+            Array php_key_bins = iter.second().toArray();
+            bool header_only = php_key_bins.exists(s_header_only) &&
+                php_key_bins[s_header_only].toBoolean();
+
+            if (!php_key_bins.exists(s_bins) || php_key_bins[s_bins].isNull()) {
+                shape.read_all_bins = !header_only;
+                continue;
+            }
+            if (header_only) {
+                return as_error_update(&error, AEROSPIKE_ERR_PARAM,
+                        "Bins and header_only are exclusive");
+            }
+            if (!php_key_bins[s_bins].isArray()) {
+                return as_error_update(&error, AEROSPIKE_ERR_PARAM,
+                        "Bins of a key must be an array of bin names or NULL");
+            }
+
+            shape.read_all_bins = false;
+            shape.first_bin_name = this->bin_names.size();
+            for (ArrayIter bins_iter(php_key_bins[s_bins].toArray()); bins_iter; ++bins_iter) {
+                Variant bin = bins_iter.second();
+                if (!bin.isString()) {
+                    return as_error_update(&error, AEROSPIKE_ERR_PARAM,
+                            "Bin name in filter bins must be a string");
+                }
+                this->bin_names.push_back(bin.toString().c_str());
+                shape.n_bin_names++;
+            }
+        }
         return error.code;
     }
 
+    /*
+     *******************************************************************************************
+     * Public member function that is used to invoke a batch read of the bins
+     * set by prepare_batch_read(). The keys are read with a single batch
+     * command per node, unless the batch is split into sub-batches.
+     *
+     * @param as_p                  aerospike pointer for the current batch operation.
+     * @param php_keys_to_bins      The PHP array given to prepare_batch_read().
+     * @param php_records           The return php_records to be populated
+     *                              with the record of each key, NULL if it
+     *                              does not exist or could not be read.
+     * @param php_statuses          The return php_statuses to be populated
+     *                              with the status of each key.
+     * @param batch_policy          The as_policy_batch to be used for this
+     *                              operation.
+     * @param chunking              How to split the batch into sub-batches.
+     * @param error                 as_error reference to be populated by this
+     *                              method in case of error.
+     *
+     * @return AEROSPIKE_OK if SUCCESS. Otherwise AEROSPIKE_ERR_*.
+     *******************************************************************************************
+     */
+    as_status BatchOpManager::execute_batch_read(aerospike *as_p,
+            const Array& php_keys_to_bins, Array &php_records,
+            Array &php_statuses, as_policy_batch& batch_policy,
+            const batch_chunking& chunking, as_error& error)
+    {
+        uint32_t            keys_size = this->batch.keys.size;
+
+        as_error_reset(&error);
+        if (!keys_size) {
+            return error.code;
+        }
+
+        Array positional_records = create_positional_result(keys_size);
+        Array positional_statuses = create_positional_result(keys_size);
+        batch_read_udata udata(positional_records, positional_statuses, error, true);
+        execute_chunks(as_p, batch_policy, whole_batch_chunking(chunking), NULL, 0,
+                true, &populate_get_result, udata, error);
+
+        if (php_keys_to_bins.isVectorData()) {
+            php_records = positional_records;
+            php_statuses = positional_statuses;
+        } else {
+            int64_t position = 0;
+            for (ArrayIter iter(php_keys_to_bins); iter; ++iter, position++) {
+                php_records.set(iter.first(), positional_records[position]);
+                php_statuses.set(iter.first(), positional_statuses[position]);
+            }
+        }
+        return set_failed_keys_error(udata, error);
+    }
+
     /*
      *******************************************************************************************
      * Destructor for BatchOpManager, destroys the maintained as_batch instance
@@ -0,0 +1,410 @@
+#include "batch_write_manager.h"
+#include "async_operations.h"
+#include "ext_aerospike.h"
+
+#include <algorithm>
+
+namespace HPHP {
+
+    /*
+     *******************************************************************************************
+     * This constructor allocates one entry per record of the php_records
+     * array passed here.
+     *
+     * @param php_records   PHP Array reference to the PHP records array to be
+     *                      used for the batch write.
+     *******************************************************************************************
+     */
+    BatchWriteManager::BatchWriteManager(const Array& php_records)
+    {
+        entries_size = php_records.size();
+        entries_p = new batch_write_entry[entries_size ? entries_size : 1];
+    }
+
+    /*
+     *******************************************************************************************
+     * Destructor for BatchWriteManager, destroys the converted keys, records
+     * and operations, and the records returned by the operations.
+     *******************************************************************************************
+     */
+    BatchWriteManager::~BatchWriteManager()
+    {
+        for (uint32_t iter = 0; iter < entries_size; iter++) {
+            if (entries_p[iter].rec_initialized) {
+                as_record_destroy(&entries_p[iter].rec);
+            }
+            if (entries_p[iter].operations_initialized) {
+                as_operations_destroy(&entries_p[iter].operations);
+            }
+            if (entries_p[iter].result_p) {
+                as_record_destroy(entries_p[iter].result_p);
+            }
+            if (entries_p[iter].key_initialized) {
+                as_key_destroy(&entries_p[iter].key);
+            }
+        }
+        delete[] entries_p;
+    }
+
+    /*
+     *******************************************************************************************
+     * Public member function that converts the records of a putMany.
+     * Each record is an array("key" => key, "bins" => array of bins).
+     *
+     * @param php_records           The PHP records array.
+     * @param ttl                   The ttl of the records.
+     * @param policy_manager        The PolicyManager of the write policy, used
+     *                              to set the generation of each record.
+     * @param options               The options of the putMany.
+     * @param serializer_option     The serializer of the bins.
+     * @param error                 as_error reference to be populated by this
+     *                              method in case of error.
+     *
+     * @return AEROSPIKE_OK if SUCCESS. Otherwise AEROSPIKE_ERR_*.
+     *******************************************************************************************
+     */
+    as_status BatchWriteManager::prepare_puts(const Array& php_records, int64_t ttl,
+            PolicyManager& policy_manager, const Variant& options,
+            int16_t serializer_option, as_error& error)
+    {
+        uint32_t            iter_entries = 0;
+
+        as_error_reset(&error);
+
+        for (ArrayIter iter(php_records); iter; ++iter, iter_entries++) {
+            batch_write_entry& entry = entries_p[iter_entries];
+            const Variant& php_record = iter.secondRef();
+
+            if (!php_record.isArray() || !php_record.toCArrRef().exists(s_key) ||
+                    !php_record.toCArrRef().exists(s_bins) ||
+                    !php_record.toCArrRef()[s_bins].isArray()) {
+                return as_error_update(&error, AEROSPIKE_ERR_PARAM,
+                        "Each record must be an array(key, bins)");
+            }
+
+            if (AEROSPIKE_OK != php_key_to_as_key(php_record.toCArrRef()[s_key],
+                        entry.key, error)) {
+                return error.code;
+            }
+            entry.key_initialized = true;
+
+            /*
+             * Set first, as the record owns the packed lists and maps even if
+             * the conversion fails.
+             */
+            entry.rec_initialized = true;
+            if (AEROSPIKE_OK != php_record_to_as_record(php_record.toCArrRef()[s_bins].toArray(),
+                        entry.rec, ttl, static_pool, serializer_option, error)) {
+                return error.code;
+            }
+
+            if (AEROSPIKE_OK != policy_manager.set_generation_value(&entry.rec.gen,
+                        options, error)) {
+                return error.code;
+            }
+        }
+        return error.code;
+    }
+
+    /*
+     *******************************************************************************************
+     * Private member function that runs write on every entry, splitting the
+     * entries into ranges written concurrently. The first range is written
+     * by the calling thread, the others by the workers of the
+     * AsyncCommandPool. Returns once all the ranges are written.
+     *
+     * @param write                 The function writing an entry, called on
+     *                              any thread; it returns the status of the
+     *                              entry. The entry counts as failed if its
+     *                              as_error is left set.
+     * @param error                 as_error reference to be populated by this
+     *                              method with the error of the first failed
+     *                              entry.
+     *
+     * @return AEROSPIKE_OK if no entry failed. Otherwise the status of the
+     * first failed entry.
+     *******************************************************************************************
+     */
+    as_status BatchWriteManager::execute_jobs(
+            const std::function<as_status(batch_write_entry&, as_error&)>& write,
+            as_error& error)
+    {
+        uint32_t                    jobs_size = std::max(1u, std::min((uint32_t) ASYNC_COMMAND_WORKERS + 1,
+                                        entries_size / BATCH_WRITE_MIN_JOB_SIZE));
+        uint32_t                    job_length = (entries_size + jobs_size - 1) / jobs_size;
+        std::vector<as_error>       job_errors(jobs_size);
+        std::mutex                  lock;
+        std::condition_variable     cond;
+        uint32_t                    pending_jobs = jobs_size;
+
+        as_error_reset(&error);
+
+        auto run_job = [&](uint32_t job) {
+            as_error *job_error_p = &job_errors[job];
+            as_error_init(job_error_p);
+            uint32_t end = std::min(entries_size, (job + 1) * job_length);
+            for (uint32_t iter = job * job_length; iter < end; iter++) {
+                as_error entry_error;
+                as_error_init(&entry_error);
+                entries_p[iter].status = write(entries_p[iter], entry_error);
+                if (entry_error.code != AEROSPIKE_OK && job_error_p->code == AEROSPIKE_OK) {
+                    as_error_copy(job_error_p, &entry_error);
+                }
+            }
+            std::lock_guard<std::mutex> guard(lock);
+            if (--pending_jobs == 0) {
+                cond.notify_one();
+            }
+        };
+
+        for (uint32_t job = 1; job < jobs_size; job++) {
+            if (!async_command_pool.enqueue([&run_job, job] { run_job(job); })) {
+                run_job(job);
+            }
+        }
+        run_job(0);
+
+        {
+            std::unique_lock<std::mutex> guard(lock);
+            cond.wait(guard, [&] { return pending_jobs == 0; });
+        }
+
+        for (uint32_t job = 0; job < jobs_size; job++) {
+            if (job_errors[job].code != AEROSPIKE_OK) {
+                as_error_copy(&error, &job_errors[job]);
+                break;
+            }
+        }
+        return error.code;
+    }
+
+    /*
+     *******************************************************************************************
+     * Private member function that populates php_statuses with the status
+     * of each entry, under the key of its record in php_records.
+     *******************************************************************************************
+     */
+    void BatchWriteManager::populate_statuses(const Array& php_records, Array& php_statuses)
+    {
+        uint32_t            iter_entries = 0;
+
+        for (ArrayIter iter(php_records); iter; ++iter, iter_entries++) {
+            php_statuses.set(iter.first(), (int64_t) entries_p[iter_entries].status);
+        }
+    }
+
+    /*
+     *******************************************************************************************
+     * Public member function that is used to invoke a batch put operation.
+     *
+     * @param as_p                  aerospike pointer for the current batch operation.
+     * @param php_records           The PHP records array given to prepare_puts().
+     * @param php_statuses          The return php_statuses to be populated
+     *                              with the status of each record.
+     * @param write_policy          The as_policy_write to be used for this
+     *                              operation.
+     * @param error                 as_error reference to be populated by this
+     *                              method in case of error.
+     *
+     * @return AEROSPIKE_OK if all the records were written. Otherwise the
+     * status of the first failed record.
+     *******************************************************************************************
+     */
+    as_status BatchWriteManager::execute_puts(aerospike *as_p, const Array& php_records,
+            Array& php_statuses, as_policy_write& write_policy, as_error& error)
+    {
+        as_error_reset(&error);
+
+        if (entries_size) {
+            execute_jobs([as_p, &write_policy](batch_write_entry& entry, as_error& entry_error) {
+                    return aerospike_key_put(as_p, &entry_error, &write_policy,
+                            &entry.key, &entry.rec);
+                    }, error);
+        }
+        populate_statuses(php_records, php_statuses);
+        return error.code;
+    }
+
+    /*
+     *******************************************************************************************
+     * Public member function that converts the operations of an operateMany.
+     * Each element is an array("key" => key, "operations" => array of
+     * operations as accepted by Aerospike::operate()).
+     *
+     * @param php_keys_to_ops       The PHP array of keys and their operations.
+     * @param policy_manager        The PolicyManager of the operate policy,
+     *                              used to set the generation and ttl of each
+     *                              record.
+     * @param options               The options of the operateMany.
+     * @param serializer_option     The serializer of the operation values.
+     * @param error                 as_error reference to be populated by this
+     *                              method in case of error.
+     *
+     * @return AEROSPIKE_OK if SUCCESS. Otherwise AEROSPIKE_ERR_*.
+     *******************************************************************************************
+     */
+    as_status BatchWriteManager::prepare_operates(const Array& php_keys_to_ops,
+            PolicyManager& policy_manager, const Variant& options,
+            int16_t serializer_option, as_error& error)
+    {
+        uint32_t            iter_entries = 0;
+
+        as_error_reset(&error);
+
+        for (ArrayIter iter(php_keys_to_ops); iter; ++iter, iter_entries++) {
+            batch_write_entry& entry = entries_p[iter_entries];
+            const Variant& php_key_ops = iter.secondRef();
+
+            if (!php_key_ops.isArray() || !php_key_ops.toCArrRef().exists(s_key) ||
+                    !php_key_ops.toCArrRef().exists(s_operations) ||
+                    !php_key_ops.toCArrRef()[s_operations].isArray()) {
+                return as_error_update(&error, AEROSPIKE_ERR_PARAM,
+                        "Each element must be an array(key, operations)");
+            }
+
+            if (AEROSPIKE_OK != php_key_to_as_key(php_key_ops.toCArrRef()[s_key],
+                        entry.key, error)) {
+                return error.code;
+            }
+            entry.key_initialized = true;
+
+            if (AEROSPIKE_OK != php_operations_to_as_operations(
+                        php_key_ops.toCArrRef()[s_operations].toArray(),
+                        entry.operations, static_pool, serializer_option, error)) {
+                return error.code;
+            }
+            entry.operations_initialized = true;
+
+            if (AEROSPIKE_OK != policy_manager.set_generation_value(&entry.operations.gen,
+                        options, error) ||
+                    AEROSPIKE_OK != policy_manager.set_ttl_value(&entry.operations.ttl,
+                        options, error)) {
+                return error.code;
+            }
+        }
+        return error.code;
+    }
+
+    /*
+     *******************************************************************************************
+     * Public member function that is used to invoke a batch operate operation.
+     *
+     * @param as_p                  aerospike pointer for the current batch operation.
+     * @param php_keys_to_ops       The PHP array given to prepare_operates().
+     * @param php_results           The return php_results to be populated, under
+     *                              the key of each element of php_keys_to_ops,
+     *                              with array("status" => int, "returned" =>
+     *                              bins returned by the operations).
+     * @param operate_policy        The as_policy_operate to be used for this
+     *                              operation.
+     * @param error                 as_error reference to be populated by this
+     *                              method in case of error.
+     *
+     * @return AEROSPIKE_OK if all the operations succeeded. Otherwise the
+     * status of the first failed key.
+     *******************************************************************************************
+     */
+    as_status BatchWriteManager::execute_operates(aerospike *as_p, const Array& php_keys_to_ops,
+            Array& php_results, as_policy_operate& operate_policy, as_error& error)
+    {
+        uint32_t            iter_entries = 0;
+
+        as_error_reset(&error);
+
+        if (entries_size) {
+            execute_jobs([as_p, &operate_policy](batch_write_entry& entry, as_error& entry_error) {
+                    return aerospike_key_operate(as_p, &entry_error, &operate_policy,
+                            &entry.key, &entry.operations, &entry.result_p);
+                    }, error);
+        }
+
+        for (ArrayIter iter(php_keys_to_ops); iter; ++iter, iter_entries++) {
+            batch_write_entry& entry = entries_p[iter_entries];
+            Array php_returned = Array::Create();
+            if (entry.result_p) {
+                as_error conversion_error;
+                as_error_init(&conversion_error);
+                if (AEROSPIKE_OK != bins_to_php_bins(entry.result_p, php_returned,
+                            conversion_error)) {
+                    /* The operations were applied, but their result is lost */
+                    entry.status = conversion_error.code;
+                    php_returned = Array::Create();
+                    if (error.code == AEROSPIKE_OK) {
+                        as_error_copy(&error, &conversion_error);
+                    }
+                }
+            }
+            Array php_result = Array::Create();
+            php_result.set(s_status, (int64_t) entry.status);
+            php_result.set(s_returned, php_returned);
+            php_results.set(iter.first(), php_result);
+        }
+        return error.code;
+    }
+
+    /*
+     *******************************************************************************************
+     * Public member function that converts the keys of a removeMany.
+     *
+     * @param php_keys              The PHP keys array.
+     * @param error                 as_error reference to be populated by this
+     *                              method in case of error.
+     *
+     * @return AEROSPIKE_OK if SUCCESS. Otherwise AEROSPIKE_ERR_*.
+     *******************************************************************************************
+     */
+    as_status BatchWriteManager::prepare_removes(const Array& php_keys, as_error& error)
+    {
+        uint32_t            iter_entries = 0;
+
+        as_error_reset(&error);
+
+        for (ArrayIter iter(php_keys); iter; ++iter, iter_entries++) {
+            batch_write_entry& entry = entries_p[iter_entries];
+            if (AEROSPIKE_OK != php_key_to_as_key(iter.secondRef(), entry.key, error)) {
+                return error.code;
+            }
+            entry.key_initialized = true;
+        }
+        return error.code;
+    }
+
+    /*
+     *******************************************************************************************
+     * Public member function that is used to invoke a batch remove operation.
+     * A key which is not found is reported as AEROSPIKE_ERR_RECORD_NOT_FOUND
+     * in php_statuses, without failing the batch.
+     *
+     * @param as_p                  aerospike pointer for the current batch operation.
+     * @param php_keys              The PHP keys array given to prepare_removes().
+     * @param php_statuses          The return php_statuses to be populated
+     *                              with the status of each key.
+     * @param remove_policy         The as_policy_remove to be used for this
+     *                              operation.
+     * @param error                 as_error reference to be populated by this
+     *                              method in case of error.
+     *
+     * @return AEROSPIKE_OK if all the keys were removed or not found.
+     * Otherwise the status of the first failed key.
+     *******************************************************************************************
+     */
+    as_status BatchWriteManager::execute_removes(aerospike *as_p, const Array& php_keys,
+            Array& php_statuses, as_policy_remove& remove_policy, as_error& error)
+    {
+        as_error_reset(&error);
+
+        if (entries_size) {
+            execute_jobs([as_p, &remove_policy](batch_write_entry& entry, as_error& entry_error) {
+                    as_status status = aerospike_key_remove(as_p, &entry_error,
+                            &remove_policy, &entry.key);
+                    if (status == AEROSPIKE_ERR_RECORD_NOT_FOUND) {
+                        /* Reported in php_statuses only */
+                        as_error_reset(&entry_error);
+                    }
+                    return status;
+                    }, error);
+        }
+        populate_statuses(php_keys, php_statuses);
+        return error.code;
+    }
+} // namespace HPHP
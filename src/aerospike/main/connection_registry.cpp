@@ -0,0 +1,191 @@
+#include "connection_registry.h"
+
+#include <string.h>
+
+namespace HPHP {
+
+    /*
+     * Process wide registry of persistent connections
+     */
+    PersistentConnectionRegistry persistent_registry;
+
+    /*
+     *******************************************************************************************
+     * Constructor for PersistentConnectionRegistry, marks all the slots empty.
+     *******************************************************************************************
+     */
+    PersistentConnectionRegistry::PersistentConnectionRegistry()
+    {
+        for (uint32_t iter = 0; iter < PERSISTENT_REGISTRY_SLOTS; iter++) {
+            slots[iter].store(NULL, std::memory_order_relaxed);
+        }
+    }
+
+    /*
+     *******************************************************************************************
+     * FNV-1a hash of a NULL terminated string, continued from seed.
+     *******************************************************************************************
+     */
+    static inline uint64_t fnv1a(const char *str_p, uint64_t seed)
+    {
+        uint64_t hash = seed;
+        for (; str_p && *str_p; str_p++) {
+            hash ^= (uint8_t) *str_p;
+            hash *= 0x100000001b3ULL;
+        }
+        return hash;
+    }
+
+    /*
+     *******************************************************************************************
+     * Final avalanche step of a 64-bit hash.
+     *******************************************************************************************
+     */
+    static inline uint64_t mix64(uint64_t hash)
+    {
+        hash ^= hash >> 33;
+        hash *= 0xff51afd7ed558ccdULL;
+        hash ^= hash >> 33;
+        hash *= 0xc4ceb53fe1a85ec9ULL;
+        hash ^= hash >> 33;
+        return hash;
+    }
+
+    /*
+     *******************************************************************************************
+     * Computes the registry key of a cluster configuration out of its hosts
+     * and user. The hosts are combined independently of their order, so the
+     * same seed list given in a different order maps to the same connection.
+     *
+     * @param config        as_config of the cluster.
+     *
+     * @return the 64-bit hash of the configuration.
+     *******************************************************************************************
+     */
+    uint64_t PersistentConnectionRegistry::hash_config(const as_config& config)
+    {
+        uint64_t hash = mix64(fnv1a(config.user, 0xcbf29ce484222325ULL));
+
+        for (uint32_t iter_hosts = 0; config.hosts && iter_hosts < config.hosts->size; iter_hosts++) {
+            as_host *host_p = (as_host *) as_vector_get(config.hosts, iter_hosts);
+            uint64_t host_hash = fnv1a(host_p->name, 0xcbf29ce484222325ULL);
+            host_hash ^= host_p->port;
+            hash += mix64(host_hash * 0x100000001b3ULL);
+        }
+        return hash;
+    }
+
+    /*
+     *******************************************************************************************
+     * Checks whether the entry was created for the given cluster configuration,
+     * i.e. with the same user and the same set of hosts.
+     *******************************************************************************************
+     */
+    bool PersistentConnectionRegistry::config_matches(const as_config& config, const aerospike_ref *entry_p)
+    {
+        const as_config& entry_config = entry_p->as_p->config;
+        uint32_t config_hosts_size = config.hosts ? config.hosts->size : 0;
+        uint32_t entry_hosts_size = entry_config.hosts ? entry_config.hosts->size : 0;
+
+        if (config_hosts_size != entry_hosts_size || strcmp(config.user, entry_config.user) != 0) {
+            return false;
+        }
+
+        for (uint32_t iter_hosts = 0; iter_hosts < config_hosts_size; iter_hosts++) {
+            as_host *host_p = (as_host *) as_vector_get(config.hosts, iter_hosts);
+            bool found = false;
+            for (uint32_t iter_entry = 0; iter_entry < entry_hosts_size && !found; iter_entry++) {
+                as_host *entry_host_p = (as_host *) as_vector_get(entry_config.hosts, iter_entry);
+                found = (host_p->port == entry_host_p->port &&
+                        strcmp(host_p->name, entry_host_p->name) == 0);
+            }
+            if (!found) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /*
+     *******************************************************************************************
+     * Looks up the entry of the given cluster configuration. Lock-free, does
+     * not allocate.
+     *
+     * @param config        as_config of the cluster.
+     * @param config_hash   hash_config() of the config.
+     *
+     * @return the aerospike_ref of the cluster if present. Otherwise NULL.
+     *******************************************************************************************
+     */
+    aerospike_ref* PersistentConnectionRegistry::find(const as_config& config, uint64_t config_hash)
+    {
+        uint32_t slot = (uint32_t) (config_hash & (PERSISTENT_REGISTRY_SLOTS - 1));
+
+        for (uint32_t probe = 0; probe < PERSISTENT_REGISTRY_SLOTS; probe++) {
+            aerospike_ref *entry_p = slots[slot].load(std::memory_order_acquire);
+            if (!entry_p) {
+                return NULL;
+            }
+            if (entry_p->config_hash == config_hash && config_matches(config, entry_p)) {
+                return entry_p;
+            }
+            slot = (slot + 1) & (PERSISTENT_REGISTRY_SLOTS - 1);
+        }
+        return NULL;
+    }
+
+    /*
+     *******************************************************************************************
+     * Publishes a new entry. entry_p->config_hash must already be set and
+     * entry_p->as_p must hold the configuration the entry was created with.
+     *
+     * @param config        as_config of the cluster.
+     * @param entry_p       aerospike_ref to be published.
+     *
+     * @return entry_p if it was published, the entry of another thread that
+     * published the same configuration first, or NULL if the registry is full.
+     *******************************************************************************************
+     */
+    aerospike_ref* PersistentConnectionRegistry::insert(const as_config& config, aerospike_ref *entry_p)
+    {
+        uint32_t slot = (uint32_t) (entry_p->config_hash & (PERSISTENT_REGISTRY_SLOTS - 1));
+
+        for (uint32_t probe = 0; probe < PERSISTENT_REGISTRY_SLOTS; probe++) {
+            aerospike_ref *current_p = NULL;
+            if (slots[slot].compare_exchange_strong(current_p, entry_p,
+                        std::memory_order_acq_rel, std::memory_order_acquire)) {
+                return entry_p;
+            }
+            if (current_p->config_hash == entry_p->config_hash && config_matches(config, current_p)) {
+                return current_p;
+            }
+            slot = (slot + 1) & (PERSISTENT_REGISTRY_SLOTS - 1);
+        }
+        return NULL;
+    }
+
+    /*
+     *******************************************************************************************
+     * Closes and frees all the entries. To be called at module shutdown only,
+     * when no request can be using them any more.
+     *
+     * @param error         as_error reference to be populated by this function
+     *                      in case of error
+     *******************************************************************************************
+     */
+    void PersistentConnectionRegistry::close_all(as_error& error)
+    {
+        for (uint32_t iter = 0; iter < PERSISTENT_REGISTRY_SLOTS; iter++) {
+            aerospike_ref *entry_p = slots[iter].exchange(NULL, std::memory_order_acq_rel);
+            if (!entry_p) {
+                continue;
+            }
+            if (entry_p->as_p) {
+                aerospike_close(entry_p->as_p, &error);
+                aerospike_destroy(entry_p->as_p);
+                entry_p->as_p = NULL;
+            }
+            delete entry_p;
+        }
+    }
+} // namespace HPHP
@@ -1,6 +1,7 @@
 #include "conversions.h"
 #include "ext_aerospike.h"
 #include "constants.h"
+#include "msgpack_packer.h"
 
 namespace HPHP {
 
@@ -60,6 +61,67 @@ namespace HPHP {
         return alias_to_search;
      }
 
+    /*
+     * Per-thread cache of pool chunks released by StaticPoolManager instances.
+     * HHVM serves a request entirely on one thread, so the chunks parked here
+     * are reused by the subsequent calls within the same request.
+     */
+    static thread_local std::vector<void *> pool_chunk_cache;
+
+    /*
+     *******************************************************************************************
+     * Function to get a chunk of POOL_CHUNK_SIZE bytes for a ChunkedPool,
+     * preferably from the per-thread cache.
+     *
+     * @return a pointer to the chunk if success. Otherwise NULL.
+     *******************************************************************************************
+     */
+    void* acquire_pool_chunk()
+    {
+        if (!pool_chunk_cache.empty()) {
+            void *chunk_p = pool_chunk_cache.back();
+            pool_chunk_cache.pop_back();
+            return chunk_p;
+        }
+        return malloc(POOL_CHUNK_SIZE);
+    }
+
+    /*
+     *******************************************************************************************
+     * Function to give back a chunk acquired by acquire_pool_chunk().
+     * The chunk is parked in the per-thread cache, unless the cache is full.
+     *
+     * @param chunk_p       The chunk to be released.
+     *******************************************************************************************
+     */
+    void release_pool_chunk(void *chunk_p)
+    {
+        if (pool_chunk_cache.size() < POOL_CHUNK_CACHE_MAX) {
+            if (pool_chunk_cache.empty()) {
+                /* Makes sure requestShutdown() gets to free the cache */
+                Aerospike::initRequestLocals();
+            }
+            pool_chunk_cache.push_back(chunk_p);
+        } else {
+            free(chunk_p);
+        }
+    }
+
+    /*
+     *******************************************************************************************
+     * Function to free all the chunks parked in the per-thread cache.
+     * Invoked at request shutdown.
+     *******************************************************************************************
+     */
+    void free_pool_chunk_cache()
+    {
+        for (auto chunk_p : pool_chunk_cache) {
+            free(chunk_p);
+        }
+        pool_chunk_cache.clear();
+        pool_chunk_cache.shrink_to_fit();
+    }
+
     /*
      *******************************************************************************************
      * Constructor for static pool
@@ -76,10 +138,7 @@ namespace HPHP {
      */
     as_string* StaticPoolManager::get_as_string()
     {
-        if (string_pool_index >= STATIC_POOL_MAX_SIZE) {
-            return NULL;
-        }
-        return &string_pool[string_pool_index++];
+        return string_pool.get();
     }
 
     /*
@@ -91,10 +150,31 @@ namespace HPHP {
      */
     as_integer* StaticPoolManager::get_as_integer()
     {
-        if (integer_pool_index >= STATIC_POOL_MAX_SIZE) {
-            return NULL;
-        }
-        return &integer_pool[integer_pool_index++];
+        return integer_pool.get();
+    }
+
+    /*
+     *******************************************************************************************
+     * Method to get an as_double from current static pool
+     *
+     * @return a pointer to as_double if success. Otherwise NULL.
+     *******************************************************************************************
+     */
+    as_double* StaticPoolManager::get_as_double()
+    {
+        return double_pool.get();
+    }
+
+    /*
+     *******************************************************************************************
+     * Method to get an as_boolean from current static pool
+     *
+     * @return a pointer to as_boolean if success. Otherwise NULL.
+     *******************************************************************************************
+     */
+    as_boolean* StaticPoolManager::get_as_boolean()
+    {
+        return boolean_pool.get();
     }
 
     /*
@@ -106,10 +186,7 @@ namespace HPHP {
      */
     as_arraylist* StaticPoolManager::get_as_arraylist()
     {
-        if (list_pool_index >= STATIC_POOL_MAX_SIZE) {
-            return NULL;
-        }
-        return &list_pool[list_pool_index++];
+        return list_pool.get();
     }
 
     /*
@@ -121,10 +198,7 @@ namespace HPHP {
      */
     as_hashmap* StaticPoolManager::get_as_hashmap()
     {
-        if (map_pool_index >= STATIC_POOL_MAX_SIZE) {
-            return NULL;
-        }
-        return &map_pool[map_pool_index++];
+        return map_pool.get();
     }
 
     /*
@@ -136,33 +210,44 @@ namespace HPHP {
      */
     as_bytes* StaticPoolManager::get_as_bytes()
     {
-        if (bytes_pool_index >= STATIC_POOL_MAX_SIZE) {
-            return NULL;
-        }
-        return &bytes_pool[bytes_pool_index++];
+        return bytes_pool.get();
     }
 
     /*
      *******************************************************************************************
      * Destructor for Static Pool
-     * Frees up all the used as_* from the static pool
+     * Frees up all the used as_* from the static pool and releases the chunks
+     * back to the per-thread cache.
      *******************************************************************************************
      */
     StaticPoolManager::~StaticPoolManager()
     {
-        uint16_t iter = 0;
-        for (iter = 0; iter < string_pool_index; iter++) {
-            as_string_destroy(&string_pool[iter]);
+        uint32_t iter = 0;
+        for (iter = 0; iter < string_pool.size(); iter++) {
+            as_string_destroy(string_pool.at(iter));
+        }
+        for (iter = 0; iter < integer_pool.size(); iter++) {
+            as_integer_destroy(integer_pool.at(iter));
+        }
+        for (iter = 0; iter < double_pool.size(); iter++) {
+            as_double_destroy(double_pool.at(iter));
         }
-        for (iter = 0; iter < integer_pool_index; iter++) {
-            as_integer_destroy(&integer_pool[iter]);
+        for (iter = 0; iter < boolean_pool.size(); iter++) {
+            as_boolean_destroy(boolean_pool.at(iter));
         }
-        for (iter = 0; iter < list_pool_index; iter++) {
-            as_arraylist_destroy(&list_pool[iter]);
+        for (iter = 0; iter < list_pool.size(); iter++) {
+            as_arraylist_destroy(list_pool.at(iter));
         }
-        for (iter = 0; iter < map_pool_index; iter++) {
-            as_hashmap_destroy(&map_pool[iter]);
+        for (iter = 0; iter < map_pool.size(); iter++) {
+            as_hashmap_destroy(map_pool.at(iter));
         }
+        string_pool.release();
+        integer_pool.release();
+        double_pool.release();
+        boolean_pool.release();
+        list_pool.release();
+        map_pool.release();
+        bytes_pool.release();
     }
 
     /*
@@ -222,7 +307,6 @@ namespace HPHP {
             as_error& error)
     {
         Array params = Array::Create();
-        char *bytes_val_p = (char *) (*bytes)->value;
         Variant callback_arg;
 
         as_error_reset(&error);
@@ -230,7 +314,7 @@ namespace HPHP {
         if (serialize_flag) {
             params.append(value);
         } else {
-            callback_arg = String(bytes_val_p);
+            callback_arg = String((char *) (*bytes)->value);
             params.append(callback_arg);
         }
 
@@ -251,22 +335,23 @@ namespace HPHP {
 
     /*
      *******************************************************************************************************
-     * Serializes data (value_to_serialize) into as_bytes using serialization logic
+     * Serializes data (value_to_serialize) into a string using serialization logic
      * based on serializer_policy.
      *
      * @param serializer_type           The serializer_policy to be used to handle
      *                                  the serialization.
-     * @param bytes_p                   The as_bytes to be set.
      * @param value_to_serialize        The value to be serialized.
+     * @param serialized_string         The serialized string to be populated by
+     *                                  this function.
+     * @param bytes_type                The as_bytes_type matching the serializer
+     *                                  to be populated by this function.
      * @param error                     The as_error to be populated by the function
      *                                  with encountered error if any.
      *******************************************************************************************************
      */
-    as_status serialize_based_on_serializer_policy(int16_t serializer_type, as_bytes **bytes_p,
-            Variant& value_to_serialize, StaticPoolManager& static_pool, as_error& error)
+    static as_status serialize_php_variant(int16_t serializer_type, Variant& value_to_serialize,
+            HPHP::String& serialized_string, as_bytes_type& bytes_type, as_error& error)
     {
-        HPHP::String serialized_string;
-
         as_error_reset(&error);
 
         switch(serializer_type) {
@@ -276,24 +361,23 @@ namespace HPHP {
                 break;
             case SERIALIZER_PHP:
                 serialized_string = f_serialize(value_to_serialize);
-                *bytes_p = static_pool.get_as_bytes();
                 if (!serialized_string || serialized_string.size() == 0) {
                     return as_error_update(&error, AEROSPIKE_ERR_PARAM,
                             "Unable to serialize using standard PHP serializer");
                 }
-                set_as_bytes(bytes_p, serialized_string, AS_BYTES_PHP, error);
+                bytes_type = AS_BYTES_PHP;
                 break;
             case SERIALIZER_JSON:
                 as_error_update(&error, AEROSPIKE_ERR_PARAM,
                         "Unable to serialize using standard JSON serializer");
                 break;
             case SERIALIZER_USER:
-                *bytes_p = static_pool.get_as_bytes();
                 if (Aerospike::hasSerializer()) {
-                    execute_user_callback(Aerospike::serializer(), bytes_p, value_to_serialize,
+                    execute_user_callback(Aerospike::serializer(), NULL, value_to_serialize,
                             true, error);
                     if (error.code == AEROSPIKE_OK) {
-                        set_as_bytes(bytes_p, value_to_serialize.toString(), AS_BYTES_BLOB, error);
+                        serialized_string = value_to_serialize.toString();
+                        bytes_type = AS_BYTES_BLOB;
                     }
                 } else {
                     as_error_update(&error, AEROSPIKE_ERR_PARAM, "No serializer callback registered");
@@ -307,6 +391,34 @@ namespace HPHP {
         return error.code;
     }
 
+    /*
+     *******************************************************************************************************
+     * Serializes data (value_to_serialize) into as_bytes using serialization logic
+     * based on serializer_policy.
+     *
+     * @param serializer_type           The serializer_policy to be used to handle
+     *                                  the serialization.
+     * @param bytes_p                   The as_bytes to be set.
+     * @param value_to_serialize        The value to be serialized.
+     * @param error                     The as_error to be populated by the function
+     *                                  with encountered error if any.
+     *******************************************************************************************************
+     */
+    as_status serialize_based_on_serializer_policy(int16_t serializer_type, as_bytes **bytes_p,
+            Variant& value_to_serialize, StaticPoolManager& static_pool, as_error& error)
+    {
+        HPHP::String    serialized_string;
+        as_bytes_type   bytes_type = AS_BYTES_BLOB;
+
+        if (AEROSPIKE_OK == serialize_php_variant(serializer_type, value_to_serialize,
+                    serialized_string, bytes_type, error)) {
+            *bytes_p = static_pool.get_as_bytes();
+            set_as_bytes(bytes_p, serialized_string, bytes_type, error);
+        }
+
+        return error.code;
+    }
+
     /*
      *******************************************************************************************************
      * Unserializes as_bytes into Variant (php_value) using unserialization logic
@@ -698,6 +810,222 @@ namespace HPHP {
         return error.code;
     }
 
+    /*
+     *******************************************************************************************
+     * Function to convert PHP key, an array or an AerospikeKey object, into as_key.
+     * For an AerospikeKey the as_key refers to the object's key and its
+     * precomputed digest; the object must outlive the as_key.
+     *
+     * @param php_key       PHP Variant reference that holds record's key
+     * @param key           as_key reference to be populated by this function
+     * @param error         as_error reference to be populated by this function
+     *                      in case of error
+     * @return AEROSPIKE_OK if success. Otherwise AEROSPIKE_ERR_*.
+     *******************************************************************************************
+     */
+    as_status php_key_to_as_key(const Variant& php_key, as_key& key, as_error& error)
+    {
+        as_error_reset(&error);
+
+        if (php_key.isArray()) {
+            return php_key_to_as_key(php_key.toCArrRef(), key, error);
+        }
+
+        AerospikeKey *key_data_p = AerospikeKey::fromVariant(php_key);
+        if (!key_data_p || !key_data_p->is_initialized) {
+            return as_error_update(&error, AEROSPIKE_ERR_PARAM,
+                    "PHP Key must be an assoc array(ns, set, key), assoc array(ns, set, digest) or an AerospikeKey");
+        }
+
+        key_data_p->alias_to(key);
+        return error.code;
+    }
+
+    /*
+     *******************************************************************************************
+     * Function to copy an as_key into one which owns its primary key, so that
+     * the copy stays valid once the PHP key array or AerospikeKey object the
+     * original refers to goes away. An already computed digest is copied
+     * along.
+     *
+     * @param key           as_key reference to be copied
+     * @param owned_key     as_key reference to be initialized by this function
+     *******************************************************************************************
+     */
+    void as_key_to_owned_as_key(const as_key& key, as_key& owned_key)
+    {
+        memcpy(&owned_key, &key, sizeof(as_key));
+        owned_key._free = false;
+        owned_key.valuep = NULL;
+
+        if (key.valuep) {
+            switch (as_val_type((as_val *) key.valuep)) {
+                case AS_INTEGER:
+                    as_integer_init(&owned_key.value.integer, key.valuep->integer.value);
+                    owned_key.valuep = &owned_key.value;
+                    break;
+                case AS_STRING:
+                    {
+                        as_string *string_p = (as_string *) &key.valuep->string;
+                        size_t len = as_string_len(string_p);
+                        char *str_p = (char *) malloc(len + 1);
+                        memcpy(str_p, as_string_get(string_p), len);
+                        str_p[len] = '\0';
+                        as_string_init_wlen(&owned_key.value.string, str_p, len, true);
+                        owned_key.valuep = &owned_key.value;
+                    }
+                    break;
+                default:
+                    break;
+            }
+        }
+    }
+
+    /*
+     *******************************************************************************************
+     * Destructor for AerospikeKey, frees the held as_key.
+     *******************************************************************************************
+     */
+    AerospikeKey::~AerospikeKey()
+    {
+        if (is_initialized) {
+            as_key_destroy(&key);
+        }
+    }
+
+    /*
+     *******************************************************************************************
+     * Initializes the held as_key and computes its digest.
+     *
+     * @param ns            Namespace of the key
+     * @param set           Set of the key
+     * @param primary_key   Primary key, or the digest if is_digest is set
+     * @param is_digest     Whether primary_key is a digest
+     * @param error         as_error reference to be populated by this function
+     *                      in case of error
+     * @return AEROSPIKE_OK if success. Otherwise AEROSPIKE_ERR_*.
+     *******************************************************************************************
+     */
+    as_status AerospikeKey::init(const Variant& ns, const Variant& set, const Variant& primary_key,
+            bool is_digest, as_error& error)
+    {
+        as_error_reset(&error);
+
+        if (is_initialized) {
+            return as_error_update(&error, AEROSPIKE_ERR_CLIENT,
+                    "AerospikeKey is already initialized");
+        }
+
+        if (!ns.isString() && !ns.isInteger()) {
+            return as_error_update(&error, AEROSPIKE_ERR_PARAM,
+                    "Invalid namespace: Expecting a string");
+        }
+        if (!set.isString() && !set.isInteger()) {
+            return as_error_update(&error, AEROSPIKE_ERR_PARAM,
+                    "Invalid set: Expecting a string");
+        }
+
+        const String ns_string = ns.toString();
+        const String set_string = set.toString();
+
+        if (is_digest) {
+            if (!primary_key.isString() || primary_key.toString().size() == 0 ||
+                    primary_key.toString().size() > AS_DIGEST_VALUE_SIZE) {
+                return as_error_update(&error, AEROSPIKE_ERR_PARAM,
+                        "Invalid digest: Expecting a string of at most 20 bytes");
+            }
+            as_digest_value digest = {0};
+            memcpy(digest, primary_key.toString().data(), primary_key.toString().size());
+            if (!as_key_init_digest(&key, ns_string.c_str(), set_string.c_str(), digest)) {
+                return as_error_update(&error, AEROSPIKE_ERR_PARAM,
+                        "Unable to initialize as_key with the given digest");
+            }
+        } else if (primary_key.isInteger()) {
+            if (!as_key_init_int64(&key, ns_string.c_str(), set_string.c_str(), primary_key.toInt64())) {
+                return as_error_update(&error, AEROSPIKE_ERR_PARAM,
+                        "Unable to initialize integer as_key");
+            }
+        } else if (primary_key.isString()) {
+            const String key_string = primary_key.toString();
+            char *key_str_p = (char *) malloc(key_string.size() + 1);
+            if (!key_str_p) {
+                return as_error_update(&error, AEROSPIKE_ERR_CLIENT,
+                        "Memory allocation failed for key");
+            }
+            memcpy(key_str_p, key_string.data(), key_string.size());
+            key_str_p[key_string.size()] = '\0';
+            as_string_init_wlen(&key.value.string, key_str_p, key_string.size(), true);
+            if (!as_key_init_value(&key, ns_string.c_str(), set_string.c_str(), &key.value)) {
+                as_string_destroy(&key.value.string);
+                return as_error_update(&error, AEROSPIKE_ERR_PARAM,
+                        "Unable to initialize string as_key");
+            }
+        } else {
+            return as_error_update(&error, AEROSPIKE_ERR_PARAM,
+                    "Invalid key: Expecting a string/integer");
+        }
+
+        is_initialized = true;
+        this->is_digest = is_digest;
+
+        if (!as_key_digest(&key)) {
+            return as_error_update(&error, AEROSPIKE_ERR_CLIENT,
+                    "Unable to compute the digest of the key");
+        }
+        return error.code;
+    }
+
+    /*
+     *******************************************************************************************
+     * Sets alias to refer to the held as_key. The alias owns nothing, so
+     * destroying it leaves the held as_key intact, and it carries the
+     * already computed digest.
+     *
+     * @param alias         as_key reference to be set by this function
+     *******************************************************************************************
+     */
+    void AerospikeKey::alias_to(as_key& alias) const
+    {
+        memcpy(&alias, &key, sizeof(as_key));
+        alias._free = false;
+        alias.valuep = NULL;
+
+        if (key.valuep) {
+            switch (as_val_type((as_val *) key.valuep)) {
+                case AS_INTEGER:
+                    as_integer_init(&alias.value.integer, key.value.integer.value);
+                    alias.valuep = &alias.value;
+                    break;
+                case AS_STRING:
+                    as_string_init_wlen(&alias.value.string, key.value.string.value,
+                            key.value.string.len, false);
+                    alias.valuep = &alias.value;
+                    break;
+                default:
+                    break;
+            }
+        }
+    }
+
+    /*
+     *******************************************************************************************
+     * Returns the AerospikeKey native data of the PHP object held by the
+     * variant, NULL if it is not an AerospikeKey object.
+     *******************************************************************************************
+     */
+    AerospikeKey* AerospikeKey::fromVariant(const Variant& php_key)
+    {
+        if (!php_key.isObject()) {
+            return NULL;
+        }
+
+        const Object& object = php_key.toCObjRef();
+        if (!object->instanceof(s_AerospikeKey)) {
+            return NULL;
+        }
+        return Native::data<AerospikeKey>(object.get());
+    }
+
     /*
      *******************************************************************************************
      * Function to determine whether a given PHP Array reference holds reference of an
@@ -707,9 +1035,9 @@ namespace HPHP {
      * @return true if associative. Otherwise false if indexed.
      *******************************************************************************************
      */
-    static bool is_assoc(Array& php_array)
+    static bool is_assoc(const Array& php_array)
     {
-        uint16_t iter_count = 0;
+        int64_t iter_count = 0;
         for (ArrayIter iter(php_array); iter; ++iter) {
             if (iter.first().isInteger() && iter.first().toInt64() == iter_count) {
                 iter_count++;
@@ -749,13 +1077,25 @@ namespace HPHP {
         if (php_variant.isInteger()) {
             if (NULL == (*val_pp = (as_val *) static_pool.get_as_integer())) {
                 return as_error_update(&error, AEROSPIKE_ERR_CLIENT,
-                        "StaticPoolManager failed to allocate as_integer: Upper limit of size exceeded!")
+                        "StaticPoolManager failed to allocate as_integer")
             }
             *val_pp = (as_val *) as_integer_init((as_integer *) *val_pp, (int64_t) php_variant.toInt64());
+        } else if (php_variant.isDouble()) {
+            if (NULL == (*val_pp = (as_val *) static_pool.get_as_double())) {
+                return as_error_update(&error, AEROSPIKE_ERR_CLIENT,
+                        "StaticPoolManager failed to allocate as_double")
+            }
+            *val_pp = (as_val *) as_double_init((as_double *) *val_pp, php_variant.toDouble());
+        } else if (php_variant.isBoolean()) {
+            if (NULL == (*val_pp = (as_val *) static_pool.get_as_boolean())) {
+                return as_error_update(&error, AEROSPIKE_ERR_CLIENT,
+                        "StaticPoolManager failed to allocate as_boolean")
+            }
+            *val_pp = (as_val *) as_boolean_init((as_boolean *) *val_pp, php_variant.toBoolean());
         } else if (php_variant.isString()) {
             if (NULL == (*val_pp = (as_val *) static_pool.get_as_string())) {
                 return as_error_update(&error, AEROSPIKE_ERR_CLIENT,
-                        "StaticPoolManager failed to allocate as_string: Upper limit of size exceeded!")
+                        "StaticPoolManager failed to allocate as_string")
             }
             *val_pp = (as_val *) as_string_init((as_string *) *val_pp, (char *) php_variant.toString().c_str(), false);
         } else if (php_variant.isArray()) {
@@ -819,7 +1159,7 @@ namespace HPHP {
         if (NULL == *list_pp) {
             if (NULL == (*list_pp = (as_list *) static_pool.get_as_arraylist())) {
                 return as_error_update(&error, AEROSPIKE_ERR_CLIENT,
-                        "StaticPoolManager failed to allocate as_arraylist: Upper limit of size exceeded!")
+                        "StaticPoolManager failed to allocate as_arraylist")
             }
             *list_pp = (as_list *) as_arraylist_init((as_arraylist *) *list_pp, php_list.length(), 0);
         }
@@ -866,7 +1206,7 @@ namespace HPHP {
         if (NULL == *map_pp) {
             if (NULL == (*map_pp = (as_map *) static_pool.get_as_hashmap())) {
                 return as_error_update(&error, AEROSPIKE_ERR_CLIENT,
-                        "StaticPoolManager failed to allocate as_hashmap: Upper limit of size exceeded!");
+                        "StaticPoolManager failed to allocate as_hashmap");
             }
             *map_pp = (as_map *) as_hashmap_init((as_hashmap *) *map_pp, php_map.length());
         }
@@ -893,6 +1233,135 @@ namespace HPHP {
         return error.code;
     }
 
+    static as_status php_array_to_msgpack(const Array& php_array, bool is_map, MsgpackPacker& packer,
+            int16_t serializer_type, as_error& error);
+
+    /*
+     *******************************************************************************************
+     * Function to pack a PHP variant into msgpack, recursing into nested
+     * lists and maps. Values of types not supported by the server are
+     * serialized as per the serializer_type and packed as typed blobs.
+     *
+     * @param php_variant           PHP Variant reference that is to be packed
+     * @param packer                MsgpackPacker reference to pack the value into
+     * @param serializer_type       The serializer_type to be used to handle
+     *                              the serialization.
+     * @param error                 as_error reference to be populated by this function
+     *                              in case of error
+     *
+     * @return AEROSPIKE_OK if success. Otherwise AEROSPIKE_ERR_*.
+     *******************************************************************************************
+     */
+    static as_status php_variant_to_msgpack(const Variant& php_variant, MsgpackPacker& packer,
+            int16_t serializer_type, as_error& error)
+    {
+        if (php_variant.isInteger()) {
+            packer.pack_int64(php_variant.toInt64());
+        } else if (php_variant.isDouble()) {
+            packer.pack_double(php_variant.toDouble());
+        } else if (php_variant.isBoolean()) {
+            packer.pack_bool(php_variant.toBoolean());
+        } else if (php_variant.isString()) {
+            const String& php_string = php_variant.toCStrRef();
+            packer.pack_string(php_string.data(), php_string.size());
+        } else if (php_variant.isArray()) {
+            const Array& php_array = php_variant.toCArrRef();
+            php_array_to_msgpack(php_array, is_assoc(php_array), packer,
+                    serializer_type, error);
+        } else if (php_variant.isNull()) {
+            packer.pack_nil();
+        } else {
+            HPHP::String    serialized_string;
+            as_bytes_type   bytes_type = AS_BYTES_BLOB;
+            Variant         temp_php_variant = php_variant;
+            if (AEROSPIKE_OK == serialize_php_variant(serializer_type, temp_php_variant,
+                        serialized_string, bytes_type, error)) {
+                packer.pack_blob(bytes_type, serialized_string.data(), serialized_string.size());
+            }
+        }
+        return error.code;
+    }
+
+    /*
+     *******************************************************************************************
+     * Function to pack a PHP list/map into msgpack.
+     *
+     * @param php_array             PHP Array reference that is to be packed
+     * @param is_map                true to pack the PHP Array as a map, false
+     *                              as a list.
+     * @param packer                MsgpackPacker reference to pack the value into
+     * @param serializer_type       The serializer_type to be used to handle
+     *                              the serialization.
+     * @param error                 as_error reference to be populated by this function
+     *                              in case of error
+     *
+     * @return AEROSPIKE_OK if success. Otherwise AEROSPIKE_ERR_*.
+     *******************************************************************************************
+     */
+    static as_status php_array_to_msgpack(const Array& php_array, bool is_map, MsgpackPacker& packer,
+            int16_t serializer_type, as_error& error)
+    {
+        if (is_map) {
+            packer.pack_map_header(php_array.size());
+            for (ArrayIter iter(php_array); iter; ++iter) {
+                if (AEROSPIKE_OK != php_variant_to_msgpack(iter.first(), packer,
+                            serializer_type, error) ||
+                        AEROSPIKE_OK != php_variant_to_msgpack(iter.secondRef(), packer,
+                            serializer_type, error)) {
+                    break;
+                }
+            }
+        } else {
+            packer.pack_list_header(php_array.size());
+            for (ArrayIter iter(php_array); iter; ++iter) {
+                if (AEROSPIKE_OK != php_variant_to_msgpack(iter.secondRef(), packer,
+                            serializer_type, error)) {
+                    break;
+                }
+            }
+        }
+        return error.code;
+    }
+
+    /*
+     *******************************************************************************************
+     * Function to convert a PHP list/map straight into a pre-serialized
+     * as_bytes of type AS_BYTES_LIST/AS_BYTES_MAP, which the C client writes
+     * to the server as is. This avoids building an as_list/as_map tree which
+     * the C client would walk again to serialize it.
+     *
+     * @param php_array             PHP Array reference that is to be converted
+     * @param bytes_p               as_bytes pointer to be populated by this function
+     * @param packer                MsgpackPacker reference to be used for packing
+     * @param serializer_type       The serializer_type to be used to handle
+     *                              the serialization.
+     * @param error                 as_error reference to be populated by this function
+     *                              in case of error
+     *
+     * @return AEROSPIKE_OK if success. Otherwise AEROSPIKE_ERR_*.
+     *******************************************************************************************
+     */
+    static as_status php_array_to_packed_as_bytes(const Array& php_array, as_bytes *bytes_p,
+            MsgpackPacker& packer, int16_t serializer_type, as_error& error)
+    {
+        as_error_reset(&error);
+
+        if (!bytes_p) {
+            return as_error_update(&error, AEROSPIKE_ERR_CLIENT,
+                    "StaticPoolManager failed to allocate as_bytes");
+        }
+
+        bool is_map = is_assoc(php_array);
+        if (AEROSPIKE_OK != php_array_to_msgpack(php_array, is_map, packer,
+                    serializer_type, error)) {
+            packer.reset();
+            return error.code;
+        }
+
+        return packer.release_to_as_bytes(bytes_p,
+                is_map ? AS_BYTES_MAP : AS_BYTES_LIST, error);
+    }
+
     /*
      *******************************************************************************************
      * Function to convert PHP record into as_record
@@ -913,6 +1382,7 @@ namespace HPHP {
             StaticPoolManager& static_pool, int16_t serializer_type, as_error& error)
     {
         const char      *bin_name_p = NULL;
+        MsgpackPacker   packer;
 
         as_error_reset(&error);
 
@@ -941,30 +1411,22 @@ namespace HPHP {
                     return as_error_update(&error, AEROSPIKE_ERR_PARAM,
                         "Unable to set integer value within as_record");
                 }
+            } else if (value.isDouble()) {
+                if (!as_record_set_double(&record, bin_name_p, value.toDouble())) {
+                    return as_error_update(&error, AEROSPIKE_ERR_PARAM,
+                        "Unable to set double value within as_record");
+                }
             } else if (value.isArray()) {
-                Array php_array = value.toArray();
-                if (is_assoc(php_array)) {
-                    /* Handle map */
-                    as_map *map_p = NULL;
-                    if (AEROSPIKE_OK != php_map_to_as_map(php_array, &map_p, static_pool,
-                                serializer_type, error)) {
-                        break;
-                    }
-                    if (!as_record_set_map(&record, bin_name_p, map_p)) {
-                        return as_error_update(&error, AEROSPIKE_ERR_PARAM,
-                                "Unable to set map value within as_record");
-                    }
-                } else {
-                    /* Handle list */
-                    as_list *list_p = NULL;
-                    if (AEROSPIKE_OK != php_list_to_as_list(php_array, &list_p, static_pool,
-                                serializer_type, error)) {
-                        break;
-                    }
-                    if (!as_record_set_list(&record, bin_name_p, list_p)) {
-                        return as_error_update(&error, AEROSPIKE_ERR_PARAM,
-                                "Unable to set list value within as_record");
-                    }
+                /* Handle list and map */
+                as_bytes *bytes_p = static_pool.get_as_bytes();
+                if (AEROSPIKE_OK != php_array_to_packed_as_bytes(value.toArray(), bytes_p,
+                            packer, serializer_type, error)) {
+                    break;
+                }
+                if (!as_record_set_bytes(&record, bin_name_p, bytes_p)) {
+                    as_bytes_destroy(bytes_p);
+                    return as_error_update(&error, AEROSPIKE_ERR_PARAM,
+                            "Unable to set list/map value within as_record");
                 }
             } else {
                 /*
@@ -1074,7 +1536,15 @@ namespace HPHP {
                     }
                     
                     as_val *write_value_p = NULL;
-                    if (AEROSPIKE_OK != php_variant_to_as_val(val, &write_value_p, static_pool,
+                    if (val.isArray()) {
+                        MsgpackPacker   packer;
+                        as_bytes        *bytes_p = static_pool.get_as_bytes();
+                        if (AEROSPIKE_OK != php_array_to_packed_as_bytes(val.toArray(), bytes_p,
+                                    packer, serializer_type, error)) {
+                            return error.code;
+                        }
+                        write_value_p = (as_val *) bytes_p;
+                    } else if (AEROSPIKE_OK != php_variant_to_as_val(val, &write_value_p, static_pool,
                                 serializer_type, error)) {
                         return error.code;
                     }
@@ -1178,36 +1648,10 @@ namespace HPHP {
 
     /*
      *******************************************************************************************
-     * Callback function for each as_list element
-     * Appends corresponding PHP value for current as_value (element of the
-     * as_list) to the PHP list passed within udata_p
-     *
-     * @param value_p       An as_val list element
-     * @param udata_p       foreach_callback_udata pointer which wraps us the PHP list
-     *                      to be appended to by this function and as_error reference
-     *                      to be populated in case of error.
-     * @return AEROSPIKE_OK if success. Otherwise AEROSPIKE_ERR_*.
-     *******************************************************************************************
-     */
-    static bool list_to_php_list_foreach_callback(as_val *value_p, void *udata_p)
-    {
-        if (!value_p) {
-            return false;
-        }
-
-        foreach_callback_udata *conversion_data_p = (foreach_callback_udata *) udata_p;
-        Variant php_value;
-        if (AEROSPIKE_OK != as_val_to_php_variant(value_p, php_value, conversion_data_p->error)) {
-            return false;
-        }
-
-        conversion_data_p->data.append(php_value);
-        return true;
-    }
-
-    /*
-     *******************************************************************************************
-     * Function to convert as_list into PHP list
+     * Function to convert as_list into PHP list.
+     * Walks the list by index (lists read from the server are as_arraylists)
+     * and appends straight into a PHP packed array reserved for the size of
+     * the as_list.
      *
      * @param list_p        as_list to be converted by this function
      * @param php_list      PHP Variant reference to be populated by this
@@ -1224,51 +1668,28 @@ namespace HPHP {
             return as_error_update(&error, AEROSPIKE_ERR_CLIENT,
                     "List is null");
         }
-        Array                       temp_php_list = Array::Create();
-        foreach_callback_udata      udata(temp_php_list, error);
-        as_list_foreach(list_p, (as_list_foreach_callback) list_to_php_list_foreach_callback, &udata);
-        php_list = temp_php_list;
-        return error.code;
-    }
 
-    /*
-     *******************************************************************************************
-     * Callback function for each as_map element
-     * Sets corresponding PHP values for current as_values (key and value of the
-     * as_map) within the PHP map passed within udata_p
-     *
-     * @param key_p         An as_val map key
-     * @param value_p       An as_val map value
-     * @param udata_p       foreach_callback_udata pointer which wraps us the PHP map
-     *                      to be set by this function and as_error reference
-     *                      to be populated in case of error.
-     * @return AEROSPIKE_OK if success. Otherwise AEROSPIKE_ERR_*.
-     *******************************************************************************************
-     */
-    static bool map_to_php_map_foreach_callback(as_val *key_p, as_val *value_p, void *udata_p)
-    {
-        if (!key_p || !value_p) {
-            return false;
-        }
+        uint32_t            size = as_list_size((as_list *) list_p);
+        PackedArrayInit     temp_php_list(size);
 
-        foreach_callback_udata *conversion_data_p = (foreach_callback_udata *) udata_p;
-        Variant php_key;
-        if (AEROSPIKE_OK != as_val_to_php_variant(key_p, php_key, conversion_data_p->error)) {
-            return false;
-        }
-
-        Variant php_value;
-        if (AEROSPIKE_OK != as_val_to_php_variant(value_p, php_value, conversion_data_p->error)) {
-            return false;
+        for (uint32_t i = 0; i < size; i++) {
+            const as_val *value_p = as_list_get(list_p, i);
+            Variant php_value;
+            if (value_p && AEROSPIKE_OK != as_val_to_php_variant(value_p, php_value, error)) {
+                break;
+            }
+            temp_php_list.append(php_value);
         }
 
-        conversion_data_p->data.set(php_key, php_value);
-        return true;
+        php_list = temp_php_list.toArray();
+        return error.code;
     }
 
     /*
      *******************************************************************************************
-     * Function to convert as_map into PHP map
+     * Function to convert as_map into PHP map.
+     * Walks the map with an as_iterator and sets the pairs straight into a
+     * PHP array reserved for the size of the as_map.
      *
      * @param map_p         as_map to be converted by this function
      * @param php_map       PHP Variant reference to be populated by this
@@ -1285,10 +1706,31 @@ namespace HPHP {
             return as_error_update(&error, AEROSPIKE_ERR_CLIENT,
                     "Map is null");
         }
-        Array                       temp_php_map = Array::Create();
-        foreach_callback_udata      udata(temp_php_map, error);
-        as_map_foreach(map_p, (as_map_foreach_callback) map_to_php_map_foreach_callback, &udata);
-        php_map = temp_php_map;
+
+        ArrayInit           temp_php_map(as_map_size((as_map *) map_p), ArrayInit::Map{});
+        as_iterator         *iterator_p = as_map_iterator_new(map_p);
+        if (!iterator_p) {
+            return as_error_update(&error, AEROSPIKE_ERR_CLIENT,
+                    "Unable to iterate over map");
+        }
+
+        while (as_iterator_has_next(iterator_p)) {
+            const as_pair *pair_p = (const as_pair *) as_iterator_next(iterator_p);
+            if (!pair_p || !as_pair_1((as_pair *) pair_p) || !as_pair_2((as_pair *) pair_p)) {
+                break;
+            }
+
+            Variant php_key;
+            Variant php_value;
+            if (AEROSPIKE_OK != as_val_to_php_variant(as_pair_1((as_pair *) pair_p), php_key, error) ||
+                    AEROSPIKE_OK != as_val_to_php_variant(as_pair_2((as_pair *) pair_p), php_value, error)) {
+                break;
+            }
+            temp_php_map.setUnknownKey(php_key, php_value);
+        }
+        as_iterator_destroy(iterator_p);
+
+        php_map = temp_php_map.toArray();
         return error.code;
     }
 
@@ -1316,7 +1758,7 @@ namespace HPHP {
                         return as_error_update(&error, AEROSPIKE_ERR_CLIENT,
                                 "String is null");
                     }
-                    php_value = String(as_string_get(string_p));
+                    php_value = String(as_string_get(string_p), as_string_len(string_p), CopyString);
                     break;
                 }
             case AS_INTEGER:
@@ -1329,6 +1771,26 @@ namespace HPHP {
                     php_value = as_integer_get(integer_p);
                     break;
                 }
+            case AS_DOUBLE:
+                {
+                    as_double *double_p = as_double_fromval(value_p);
+                    if (!double_p) {
+                        return as_error_update(&error, AEROSPIKE_ERR_CLIENT,
+                                "Double is null");
+                    }
+                    php_value = as_double_get(double_p);
+                    break;
+                }
+            case AS_BOOLEAN:
+                {
+                    as_boolean *boolean_p = as_boolean_fromval(value_p);
+                    if (!boolean_p) {
+                        return as_error_update(&error, AEROSPIKE_ERR_CLIENT,
+                                "Boolean is null");
+                    }
+                    php_value = as_boolean_get(boolean_p);
+                    break;
+                }
             case AS_BYTES:
                 {
                     unserialize_based_on_as_bytes_type((as_bytes *) value_p,
@@ -1367,38 +1829,9 @@ namespace HPHP {
 
     /*
      *******************************************************************************************
-     * Callback function for each bin-value within as_record
-     * Sets corresponding PHP values for current bin name and as_value within the 
-     * PHP bin array passed within udata_p
-     *
-     * @param name_p        Current bin name
-     * @param value_p       Current as_val bin value
-     * @param udata_p       foreach_callback_udata pointer which wraps us the PHP bins
-     *                      to be set by this function and as_error reference
-     *                      to be populated in case of error.
-     * @return AEROSPIKE_OK if success. Otherwise AEROSPIKE_ERR_*.
-     *******************************************************************************************
-     */
-    static bool bins_to_php_bins_foreach_callback(const char *name_p, const as_val *value_p, void *udata_p)
-    {
-        if (!name_p || !value_p) {
-            return false;
-        }
-
-        foreach_callback_udata *conversion_data_p = (foreach_callback_udata *) udata_p;
-
-        Variant php_value;
-        if (AEROSPIKE_OK != as_val_to_php_variant(value_p, php_value, conversion_data_p->error)) {
-            return false;
-        }
-
-        conversion_data_p->data.set(String(name_p), php_value);
-        return true;
-    }
-
-    /*
-     *******************************************************************************************
-     * Function to convert bins of as_record into PHP bins Array
+     * Function to convert bins of as_record into PHP bins Array.
+     * Walks the bins of the record in place; an empty php_bins is first
+     * reserved for the no. of bins in the record.
      *
      * @param record_p      as_record, the bins of which are to be converted by this function
      * @param php_bins      PHP Array reference to be populated by this
@@ -1417,8 +1850,23 @@ namespace HPHP {
                     "Record is null");
         }
 
-        foreach_callback_udata      udata(php_bins, error);
-        as_record_foreach(record_p, (as_rec_foreach_callback) bins_to_php_bins_foreach_callback, &udata);
+        const as_bins& bins = record_p->bins;
+        if (php_bins.empty()) {
+            php_bins = ArrayInit(bins.size, ArrayInit::Map{}).toArray();
+        }
+
+        for (uint16_t i = 0; i < bins.size; i++) {
+            const as_val *value_p = (const as_val *) bins.entries[i].valuep;
+            if (!value_p) {
+                continue;
+            }
+
+            Variant php_value;
+            if (AEROSPIKE_OK != as_val_to_php_variant(value_p, php_value, error)) {
+                break;
+            }
+            php_bins.set(String(bins.entries[i].name), php_value);
+        }
 
         return error.code;
     }
@@ -1491,7 +1939,8 @@ namespace HPHP {
                 case AS_STRING:
                     {
                         as_string *svalue_p = as_string_fromval(value_p);
-                        php_key.set(s_key, as_string_get(svalue_p));
+                        php_key.set(s_key, String(as_string_get(svalue_p),
+                                    as_string_len(svalue_p), CopyString));
                         break;
                     }
                 default:
@@ -7,21 +7,26 @@
 #include "ext_aerospike.h"
 #include "policy.h"
 #include "batch_op_manager.h"
+#include "batch_write_manager.h"
 #include "scan_operation.h"
 #include "udf_operations.h"
+#include "async_operations.h"
+#include "batch_iterator.h"
+#include "scan_iterator.h"
+#include "query_iterator.h"
+#include "scan_job.h"
+#include "record_stream.h"
 
 #include "hphp/runtime/base/builtin-functions.h"
 #include "aerospike/as_bytes.h"
 #include "hphp/runtime/vm/vm-regs.h"
+#include "hphp/system/systemlib.h"
 
 namespace HPHP {
 
     /*
      * Aerospike extension globals
      */
-    std::unordered_map<std::string, aerospike_ref *> persistent_list;
-    pthread_rwlock_t connection_mutex;
-
     ini_entries ini_entry;
 
     /*
@@ -43,7 +48,7 @@ namespace HPHP {
      */
     Aerospike::Aerospike() 
     {
-        pthread_rwlock_init(&latest_error_mutex, NULL);
+        as_error_init(&latest_error);
     }
 
     /*
@@ -61,22 +66,22 @@ namespace HPHP {
 
         if (as_ref_p) {
             if (is_connected) {
-                pthread_rwlock_wrlock(&connection_mutex);
                 as_ref_p->ref_php_object--;
-                pthread_rwlock_unlock(&connection_mutex);
                 is_connected = false;
 
                 if (!is_persistent) {
+                    wait_for_async_commands(as_ref_p);
                     aerospike_close(as_ref_p->as_p, &error);
                     aerospike_destroy(as_ref_p->as_p);
                     as_ref_p->as_p = NULL;
-                    free(as_ref_p);
+                    delete as_ref_p;
                 }
             } else {
                 if (!is_persistent) {
+                    wait_for_async_commands(as_ref_p);
                     aerospike_destroy(as_ref_p->as_p);
                     as_ref_p->as_p = NULL;
-                    free(as_ref_p);
+                    delete as_ref_p;
                 }
             }
             as_ref_p = NULL;
@@ -93,59 +98,6 @@ namespace HPHP {
         sweep();
     }
 
-    /*
-     ************************************************************************************
-     * This macro will create key in the unordered_map.
-     * Which is host_entry => address:port.
-     ************************************************************************************
-     */
-namespace {
-    inline char* create_new_alias(const as_config& config, int iter_hosts) {
-        assert(iter_hosts >= 0);
-        assert(iter_hosts < config.hosts->size);
-
-        as_host* const host = (as_host*)as_vector_get(config.hosts, iter_hosts);
-        auto const addr_len = strlen(host->name);
-        auto const ret_size = addr_len + 1 + MAX_PORT_SIZE + 1;
-        auto ret = static_cast<char*>(malloc(ret_size));
-
-        snprintf(ret, ret_size, "%s:%d", host->name, host->port);
-        return ret;
-    }
-}
-
-    /*
-     ************************************************************************************
-     * This function will iterate over remaining list of hosts and hash them
-     * into the persistent list, each pointing to the same aerospike ref object.
-     * Increment corresponding ref_host_entry within the aerospike_ref object.
-     ************************************************************************************
-     */
-    void Aerospike::iterate_hosts_add_entry(as_config& config, int matched_host_id) {
-        char                *alias_to_search = NULL;
-        int                 iter_hosts;
-
-        for (iter_hosts = 0; iter_hosts < config.hosts->size; iter_hosts++) {
-            if (iter_hosts == matched_host_id) {
-                continue;
-            }
-            alias_to_search = create_new_alias(config, iter_hosts);
-            /*
-             * Write lock is required as we are modifying as_ref_p and which is
-             * pointing to one of the entry in the persistent_list.
-             */
-            pthread_rwlock_wrlock(&connection_mutex);
-            as_ref_p->ref_host_entry++;
-            persistent_list[alias_to_search] = as_ref_p;
-            pthread_rwlock_unlock(&connection_mutex);
-
-            if (alias_to_search) {
-                free(alias_to_search);
-                alias_to_search = NULL;
-            }
-        }
-    }
-
     /*
      ************************************************************************************
      * This function will create new host entry.
@@ -154,82 +106,91 @@ namespace {
      */
     void Aerospike::create_new_host_entry(as_config& config, as_error& error)
     {
-        as_ref_p = (aerospike_ref *) malloc(sizeof(aerospike_ref));
+        as_ref_p = new (std::nothrow) aerospike_ref;
         if (as_ref_p == NULL) {
             as_error_update(&error, AEROSPIKE_ERR_CLIENT, "memory allocation failed");
             return;
         }
         config.thread_pool_size = 0;
-        as_ref_p->as_p = NULL;
-        as_ref_p->ref_host_entry = 0;
         as_ref_p->ref_php_object = 1;
         as_ref_p->as_p = aerospike_new(&config);
+        if (as_ref_p->as_p == NULL) {
+            delete as_ref_p;
+            as_ref_p = NULL;
+            as_error_update(&error, AEROSPIKE_ERR_CLIENT, "memory allocation failed");
+        }
     }
 
     /*
      ************************************************************************************
-     * This function will configure the connection.
-     * i.e. Creating new host entry in the persistent list, If host is not present.
-     * And reuse the same connection if hot is already present in the persistent list.
+     * This function will configure and connect the connection.
+     * i.e. Creating new entry in the persistent connection registry, if the
+     * cluster configuration is not present in it.
+     * And reuse the same connection if the configuration is already present in
+     * the registry. Once the registry holds the configuration, this takes no
+     * lock and does no allocation.
+     * A new entry is only published once it is connected, so that the
+     * registry never hands out a connection which is not established. A
+     * connection which failed to connect is private to this object and is
+     * destroyed along with it.
      ************************************************************************************
      */
     as_status Aerospike::configure_connection(as_config& config, as_error& error)
     {
-        char                *alias_to_search = NULL;
-        int                 iter_hosts;
-        int                 matched_host_id = -1;
         aerospike_ref       *host_entry = NULL;
+        uint64_t            config_hash = 0;
 
         as_error_reset(&error);
 
         config.thread_pool_size = 0;
         if (is_persistent) {
-            for (iter_hosts = 0; iter_hosts < config.hosts->size; iter_hosts++) {
-                alias_to_search = create_new_alias(config, iter_hosts);
-                pthread_rwlock_rdlock(&connection_mutex);
-                if (persistent_list[alias_to_search] != nullptr) {
-                    host_entry = persistent_list[alias_to_search];
-                    as_ref_p = host_entry;
-                    pthread_rwlock_unlock(&connection_mutex);
-                    is_connected = true;
-                    pthread_rwlock_wrlock(&connection_mutex);
-                    host_entry->ref_php_object++;
-                    pthread_rwlock_unlock(&connection_mutex);
-                    matched_host_id = iter_hosts;
-                    iterate_hosts_add_entry(config, matched_host_id);
-                } else {
-                    pthread_rwlock_unlock(&connection_mutex);
-                }
-
-                if (alias_to_search) {
-                    free(alias_to_search);
-                    alias_to_search = NULL;
-                }
-                if (matched_host_id != -1) {
-                    as_config_clear_hosts(&config);
-                    as_vector_destroy(config.hosts);
-                    return error.code;
-                }
+            config_hash = PersistentConnectionRegistry::hash_config(config);
+            host_entry = persistent_registry.find(config, config_hash);
+            if (host_entry) {
+                as_ref_p = host_entry;
+                host_entry->ref_php_object++;
+                is_connected = true;
+                as_config_clear_hosts(&config);
+                as_vector_destroy(config.hosts);
+                return error.code;
             }
+        }
 
-            alias_to_search = config.hosts->size ? create_new_alias(config, 0) : NULL;
-            create_new_host_entry(config, error);
-            if (error.code == AEROSPIKE_OK) {
-                as_ref_p->ref_host_entry++;
-                host_entry = as_ref_p;
-                pthread_rwlock_wrlock(&connection_mutex);
-                persistent_list[alias_to_search] = host_entry;
-                pthread_rwlock_unlock(&connection_mutex);
-
-                if (alias_to_search) {
-                    free(alias_to_search);
-                    alias_to_search = NULL;
-                }
+        create_new_host_entry(config, error);
+        if (error.code != AEROSPIKE_OK) {
+            return error.code;
+        }
 
-                iterate_hosts_add_entry(config, 0);
+        if (AEROSPIKE_OK != aerospike_connect(as_ref_p->as_p, &error)) {
+            as_error_update(&error, AEROSPIKE_ERR_CLUSTER,
+                    "Unable to connect to server");
+            as_ref_p->ref_php_object--;
+            is_persistent = false;
+            return error.code;
+        }
+        is_connected = true;
+
+        if (is_persistent) {
+            as_ref_p->config_hash = config_hash;
+            host_entry = persistent_registry.insert(as_ref_p->as_p->config, as_ref_p);
+            if (!host_entry) {
+                /*
+                 * Registry is full, the connection is private to this
+                 * object and is closed along with it.
+                 */
+                is_persistent = false;
+            } else if (host_entry != as_ref_p) {
+                /*
+                 * Another request published the same configuration
+                 * meanwhile, use its connection instead.
+                 */
+                aerospike_close(as_ref_p->as_p, &error);
+                aerospike_destroy(as_ref_p->as_p);
+                delete as_ref_p;
+                as_ref_p = host_entry;
+                host_entry->ref_php_object++;
+                as_error_reset(&error);
             }
-        } else {
-            create_new_host_entry(config, error);
         }
 
         return error.code;
@@ -237,17 +198,39 @@ namespace {
 
     /*
      ************************************************************************************
-     * Updates the "lastest_error" field in the object's NativeData
-     * May block while waiting for shared mutex
+     * Updates the latest error of the object.
+     * The object is only ever used by the thread of the request owning it, so
+     * no lock is needed. On success only the status code is recorded; on
+     * failure the message is copied up to its terminating null byte instead
+     * of the whole as_error buffer.
      ************************************************************************************
      */
     void Aerospike::setError(const as_error& error) {
-        pthread_rwlock_wrlock(&latest_error_mutex);
-        /* https://github.com/aerospike/aerospike-client-c/pull/33
-         * Obviates the need for this const cast.
-         */
-        as_error_copy(&latest_error, const_cast<as_error*>(&error));
-        pthread_rwlock_unlock(&latest_error_mutex);
+        latest_error_code = error.code;
+        if (error.code == AEROSPIKE_OK) {
+            return;
+        }
+
+        latest_error.code = error.code;
+        latest_error.func = error.func;
+        latest_error.file = error.file;
+        latest_error.line = error.line;
+        size_t message_length = strnlen(error.message, sizeof(latest_error.message) - 1);
+        memcpy(latest_error.message, error.message, message_length);
+        latest_error.message[message_length] = '\0';
+    }
+
+    /*
+     ************************************************************************************
+     * Returns the message of the latest error, an empty string if the latest
+     * call succeeded.
+     ************************************************************************************
+     */
+    String Aerospike::getErrorMessage() const {
+        if (latest_error_code == AEROSPIKE_OK) {
+            return empty_string();
+        }
+        return String(latest_error.message, CopyString);
     }
 
     /*
@@ -280,18 +263,7 @@ namespace {
                     config, error)) {
             if (AEROSPIKE_OK == policy_manager.set_global_defaults(&data->serializer_value,
                         options, error)) {
-                if (AEROSPIKE_OK == data->configure_connection(config, error)) {
-                    if (data->as_ref_p->ref_php_object <= 1 && data->as_ref_p->as_p) {
-                        if (AEROSPIKE_OK == aerospike_connect(data->as_ref_p->as_p,
-                                    &error)) {
-                            data->is_connected = true;
-                        } else {
-                            as_error_update(&error, AEROSPIKE_ERR_CLUSTER,
-                                    "Unable to connect to server");
-                            data->as_ref_p->ref_php_object--;
-                        }
-                    }
-                }
+                data->configure_connection(config, error);
             }
         }
 
@@ -333,17 +305,20 @@ namespace {
                     "Already disconnected!");
         } else {
             if (data->is_persistent == false) {
-                aerospike_close(data->as_ref_p->as_p, &error);
+                /*
+                 * Cleared first, so that the scans blocked on the full buffer
+                 * of an iterator stop instead of being waited for forever.
+                 */
                 data->as_ref_p->ref_php_object = 0;
+                wait_for_async_commands(data->as_ref_p);
+                aerospike_close(data->as_ref_p->as_p, &error);
             } else {
                 /*
                  * Decrements ref_php_object which indicates the no. of
                  * references for internal CSDK aerospike object being held by
                  * the various PHP userland functions.
                  */
-                pthread_rwlock_wrlock(&connection_mutex);
                 data->as_ref_p->ref_php_object--;
-                pthread_rwlock_unlock(&connection_mutex);
             }
             data->is_connected = false;
         }
@@ -388,9 +363,7 @@ namespace {
                      * references for internal CSDK aerospike object being held by
                      * the various PHP userland functions.
                      */
-                    pthread_rwlock_wrlock(&connection_mutex);
                     data->as_ref_p->ref_php_object++;
-                    pthread_rwlock_unlock(&connection_mutex);
                     data->is_connected = true;
                 } else {
                     as_error_update(&error, AEROSPIKE_ERR_CLIENT,
@@ -434,7 +407,7 @@ namespace {
 
     /* {{{ proto int Aerospike::put( array key, array record [, int ttl=0 [, array options ]] )
        Writes a record to the cluster */
-    int64_t HHVM_METHOD(Aerospike, put, const Array& php_key,
+    int64_t HHVM_METHOD(Aerospike, put, const Variant& php_key,
             const Array& php_rec, int64_t ttl,
             const Variant& options)
     {
@@ -463,14 +436,18 @@ namespace {
                         "write", &data->as_ref_p->as_p->config, error) &&
                     AEROSPIKE_OK == policy_manager.set_policy(&serializer_option,
                         data->serializer_value, options, error)) {
+                /*
+                 * The record owns the packed lists and maps as soon as they
+                 * are set, so it is destroyed even if the conversion fails.
+                 */
                 if (AEROSPIKE_OK == php_record_to_as_record(php_rec, rec,
                             ttl, static_pool, serializer_option, error)) {
                     policy_manager.set_generation_value(&rec.gen, options,
                             error);
                     aerospike_key_put(data->as_ref_p->as_p, &error,
                             &write_policy, &key, &rec);
-                    as_record_destroy(&rec);
                 }
+                as_record_destroy(&rec);
             }
         }
 
@@ -556,7 +533,7 @@ namespace {
 
     /* {{{ proto int Aerospike::get( array key, array record [, array filter [, array options]] )
        Reads a record from the cluster */
-    int64_t HHVM_METHOD(Aerospike, get, const Array& php_key, VRefParam php_rec,
+    int64_t HHVM_METHOD(Aerospike, get, const Variant& php_key, VRefParam php_rec,
             const Variant& filter_bins, const Variant& options)
     {
         VMRegAnchor         _;
@@ -611,17 +588,19 @@ namespace {
     }
     /* }}} */
 
-    /* {{{ proto int Aerospike::getMany( array keys, array &records [, array filter [, array options ]] )
+    /* {{{ proto int Aerospike::getMany( array keys, array &records [, array filter [, array options [, array &statuses ]]] )
        Returns a batch of records from the cluster */
     int64_t HHVM_METHOD(Aerospike, getMany, const Array& php_keys,
             VRefParam php_records, const Variant& filter_bins,
-            const Variant& options)
+            const Variant& options, VRefParam php_statuses)
     {
         VMRegAnchor         _;
         auto                data = Native::data<Aerospike>(this_);
         as_error            error;
         as_policy_batch     batch_policy;
         PolicyManager       policy_manager;
+        bool                positional = false;
+        batch_chunking      chunking;
 
         as_error_init(&error);
 
@@ -637,11 +616,130 @@ namespace {
                 if (AEROSPIKE_OK == policy_manager.initPolicyManager(&batch_policy,
                             "batch", &data->as_ref_p->as_p->config, error) &&
                         AEROSPIKE_OK == policy_manager.set_policy(NULL,
-                            data->serializer_value, options, error)) {
+                            data->serializer_value, options, error) &&
+                        AEROSPIKE_OK == policy_manager.set_batch_positional(&positional,
+                            options, error) &&
+                        AEROSPIKE_OK == policy_manager.set_batch_chunking(&chunking,
+                            options, error)) {
                     Array   temp_php_records = Array::Create();
+                    Array   temp_php_statuses = Array::Create();
                     batch_op_manager.execute_batch_get(data->as_ref_p->as_p,
-                            temp_php_records, filter_bins, batch_policy, error);
+                            temp_php_records, temp_php_statuses, filter_bins,
+                            batch_policy, positional, chunking, error);
+                    php_records.assignIfRef(temp_php_records);
+                    php_statuses.assignIfRef(temp_php_statuses);
+                }
+            } catch (const std::exception& e) {
+                as_error_update(&error, AEROSPIKE_ERR_CLIENT,
+                        "Failed to initialize batch operation");
+            }
+        }
+
+        data->setError(error);
+        return error.code;
+    }
+    /* }}} */
+
+    /* {{{ proto AerospikeBatchIterator Aerospike::getManyIterator( array keys [, array filter [, array options ]] )
+       Returns an iterator over a batch of records, yielding the records of
+       each chunk of keys as soon as it is read from the cluster */
+    Variant HHVM_METHOD(Aerospike, getManyIterator, const Array& php_keys,
+            const Variant& filter_bins, const Variant& options)
+    {
+        VMRegAnchor         _;
+        auto                data = Native::data<Aerospike>(this_);
+        as_error            error;
+        as_policy_batch     batch_policy;
+        PolicyManager       policy_manager;
+        Variant             php_iterator = init_null();
+
+        as_error_init(&error);
+
+        if (!data->as_ref_p || !data->as_ref_p->as_p) {
+            as_error_update(&error, AEROSPIKE_ERR_CLIENT,
+                    "Invalid aerospike connection object");
+        } else if (!data->is_connected) {
+            as_error_update(&error, AEROSPIKE_ERR_CLUSTER,
+                    "getManyIterator: connection not established");
+        } else if (AEROSPIKE_OK == policy_manager.initPolicyManager(&batch_policy,
+                    "batch", &data->as_ref_p->as_p->config, error) &&
+                AEROSPIKE_OK == policy_manager.set_policy(NULL,
+                    data->serializer_value, options, error)) {
+            Object iterator = create_object_only(s_AerospikeBatchIterator);
+            auto iterator_data = Native::data<AerospikeBatchIterator>(iterator.get());
+            if (AEROSPIKE_OK == iterator_data->init(Object(this_), data->as_ref_p,
+                        php_keys, filter_bins, batch_policy, error)) {
+                php_iterator = iterator;
+            }
+        }
+
+        data->setError(error);
+        return php_iterator;
+    }
+    /* }}} */
+
+    /*
+     ************************************************************************************
+     * Collects the keys of the elements of a selectMany() batch, each an
+     * array holding a key.
+     ************************************************************************************
+     */
+    static as_status select_many_keys(const Array& php_keys_to_bins, Array& php_keys,
+            as_error& error)
+    {
+        as_error_reset(&error);
+
+        for (ArrayIter iter(php_keys_to_bins); iter; ++iter) {
+            Variant php_key_bins = iter.second();
+            if (!php_key_bins.isArray() || !php_key_bins.toArray().exists(s_key)) {
+                return as_error_update(&error, AEROSPIKE_ERR_PARAM,
+                        "Each element must be an array with a key");
+            }
+            php_keys.append(php_key_bins.toArray()[s_key]);
+        }
+        return error.code;
+    }
+
+    /* {{{ proto int Aerospike::selectMany( array keys_to_bins, array &records [, array options [, array &statuses ]] )
+       Returns a batch of records from the cluster, selecting the bins of
+       each key separately */
+    int64_t HHVM_METHOD(Aerospike, selectMany, const Array& php_keys_to_bins,
+            VRefParam php_records, const Variant& options, VRefParam php_statuses)
+    {
+        VMRegAnchor         _;
+        auto                data = Native::data<Aerospike>(this_);
+        as_error            error;
+        as_policy_batch     batch_policy;
+        PolicyManager       policy_manager;
+        batch_chunking      chunking;
+        Array               php_keys = Array::Create();
+
+        as_error_init(&error);
+
+        if (!data->as_ref_p || !data->as_ref_p->as_p) {
+            as_error_update(&error, AEROSPIKE_ERR_CLIENT,
+                    "Invalid aerospike connection object");
+        } else if (!data->is_connected) {
+            as_error_update(&error, AEROSPIKE_ERR_CLUSTER,
+                    "selectMany: connection not established");
+        } else if (AEROSPIKE_OK == select_many_keys(php_keys_to_bins, php_keys, error)) {
+            try {
+                BatchOpManager batch_op_manager(php_keys);
+                if (AEROSPIKE_OK == policy_manager.initPolicyManager(&batch_policy,
+                            "batch", &data->as_ref_p->as_p->config, error) &&
+                        AEROSPIKE_OK == policy_manager.set_policy(NULL,
+                            data->serializer_value, options, error) &&
+                        AEROSPIKE_OK == policy_manager.set_batch_chunking(&chunking,
+                            options, error) &&
+                        AEROSPIKE_OK == batch_op_manager.prepare_batch_read(
+                            php_keys_to_bins, error)) {
+                    Array   temp_php_records = Array::Create();
+                    Array   temp_php_statuses = Array::Create();
+                    batch_op_manager.execute_batch_read(data->as_ref_p->as_p,
+                            php_keys_to_bins, temp_php_records, temp_php_statuses,
+                            batch_policy, chunking, error);
                     php_records.assignIfRef(temp_php_records);
+                    php_statuses.assignIfRef(temp_php_statuses);
                 }
             } catch (const std::exception& e) {
                 as_error_update(&error, AEROSPIKE_ERR_CLIENT,
@@ -654,9 +752,48 @@ namespace {
     }
     /* }}} */
 
+    /* {{{ proto int Aerospike::putMany( array records, array &statuses [, int ttl=0 [, array options ]] )
+       Writes a batch of records to the cluster concurrently */
+    int64_t HHVM_METHOD(Aerospike, putMany, const Array& php_records,
+            VRefParam php_statuses, int64_t ttl, const Variant& options)
+    {
+        VMRegAnchor         _;
+        auto                data = Native::data<Aerospike>(this_);
+        as_error            error;
+        as_policy_write     write_policy;
+        int16_t             serializer_option = 0;
+        PolicyManager       policy_manager;
+
+        as_error_init(&error);
+
+        if (!data->as_ref_p || !data->as_ref_p->as_p) {
+            as_error_update(&error, AEROSPIKE_ERR_CLIENT,
+                    "Invalid aerospike connection object");
+        } else if (!data->is_connected) {
+            as_error_update(&error, AEROSPIKE_ERR_CLUSTER,
+                    "putMany: connection not established");
+        } else if (AEROSPIKE_OK == policy_manager.initPolicyManager(&write_policy,
+                    "write", &data->as_ref_p->as_p->config, error) &&
+                AEROSPIKE_OK == policy_manager.set_policy(&serializer_option,
+                    data->serializer_value, options, error)) {
+            BatchWriteManager batch_write_manager(php_records);
+            if (AEROSPIKE_OK == batch_write_manager.prepare_puts(php_records, ttl,
+                        policy_manager, options, serializer_option, error)) {
+                Array   temp_php_statuses = Array::Create();
+                batch_write_manager.execute_puts(data->as_ref_p->as_p,
+                        php_records, temp_php_statuses, write_policy, error);
+                php_statuses.assignIfRef(temp_php_statuses);
+            }
+        }
+
+        data->setError(error);
+        return error.code;
+    }
+    /* }}} */
+
     /* {{{ proto int Aerospike::operate ( array key, array operations [, array &returned [, array options ]] )
        Performs multiple operations on a record */
-    int64_t HHVM_METHOD(Aerospike, operate, const Array& php_key,
+    int64_t HHVM_METHOD(Aerospike, operate, const Variant& php_key,
             const Array& php_operations, VRefParam returned,
             const Variant& options)
     {
@@ -712,9 +849,48 @@ namespace {
     }
     /* }}} */
 
+    /* {{{ proto int Aerospike::operateMany( array keys_to_ops, array &results [, array options ] )
+       Performs multiple operations on each of a batch of records concurrently */
+    int64_t HHVM_METHOD(Aerospike, operateMany, const Array& php_keys_to_ops,
+            VRefParam php_results, const Variant& options)
+    {
+        VMRegAnchor         _;
+        auto                data = Native::data<Aerospike>(this_);
+        as_error            error;
+        as_policy_operate   operate_policy;
+        int16_t             serializer_option = 0;
+        PolicyManager       policy_manager;
+
+        as_error_init(&error);
+
+        if (!data->as_ref_p || !data->as_ref_p->as_p) {
+            as_error_update(&error, AEROSPIKE_ERR_CLIENT,
+                    "Invalid aerospike connection object");
+        } else if (!data->is_connected) {
+            as_error_update(&error, AEROSPIKE_ERR_CLUSTER,
+                    "operateMany: connection not established");
+        } else if (AEROSPIKE_OK == policy_manager.initPolicyManager(&operate_policy,
+                    "operate", &data->as_ref_p->as_p->config, error) &&
+                AEROSPIKE_OK == policy_manager.set_policy(&serializer_option,
+                    data->serializer_value, options, error)) {
+            BatchWriteManager batch_write_manager(php_keys_to_ops);
+            if (AEROSPIKE_OK == batch_write_manager.prepare_operates(php_keys_to_ops,
+                        policy_manager, options, serializer_option, error)) {
+                Array   temp_php_results = Array::Create();
+                batch_write_manager.execute_operates(data->as_ref_p->as_p,
+                        php_keys_to_ops, temp_php_results, operate_policy, error);
+                php_results.assignIfRef(temp_php_results);
+            }
+        }
+
+        data->setError(error);
+        return error.code;
+    }
+    /* }}} */
+
     /* {{{ proto int Aerospike::remove( array key [, array options ] )
        Removes a record from the cluster */
-    int64_t HHVM_METHOD(Aerospike, remove, const Array& php_key,
+    int64_t HHVM_METHOD(Aerospike, remove, const Variant& php_key,
             const Variant& options)
     {
         VMRegAnchor         _;
@@ -754,9 +930,48 @@ namespace {
     }
     /* }}} */
 
+    /* {{{ proto int Aerospike::removeMany( array keys, array &statuses [, array options ] )
+       Removes a batch of records from the cluster concurrently */
+    int64_t HHVM_METHOD(Aerospike, removeMany, const Array& php_keys,
+            VRefParam php_statuses, const Variant& options)
+    {
+        VMRegAnchor         _;
+        auto                data = Native::data<Aerospike>(this_);
+        as_error            error;
+        as_policy_remove    remove_policy;
+        PolicyManager       policy_manager;
+
+        as_error_init(&error);
+
+        if (!data->as_ref_p || !data->as_ref_p->as_p) {
+            as_error_update(&error, AEROSPIKE_ERR_CLIENT,
+                    "Invalid aerospike connection object");
+        } else if (!data->is_connected) {
+            as_error_update(&error, AEROSPIKE_ERR_CLUSTER,
+                    "removeMany: connection not established");
+        } else if (AEROSPIKE_OK == policy_manager.initPolicyManager(&remove_policy,
+                    "remove", &data->as_ref_p->as_p->config, error) &&
+                AEROSPIKE_OK == policy_manager.set_policy(NULL,
+                    data->serializer_value, options, error) &&
+                AEROSPIKE_OK == policy_manager.set_generation_value(&remove_policy.generation,
+                    options, error)) {
+            BatchWriteManager batch_write_manager(php_keys);
+            if (AEROSPIKE_OK == batch_write_manager.prepare_removes(php_keys, error)) {
+                Array   temp_php_statuses = Array::Create();
+                batch_write_manager.execute_removes(data->as_ref_p->as_p,
+                        php_keys, temp_php_statuses, remove_policy, error);
+                php_statuses.assignIfRef(temp_php_statuses);
+            }
+        }
+
+        data->setError(error);
+        return error.code;
+    }
+    /* }}} */
+
     /* {{{ proto int Aerospike::removeBin( array key, array bins [, array options ])
        Removes a bin from a record */
-    int64_t HHVM_METHOD(Aerospike, removeBin, const Array& php_key,
+    int64_t HHVM_METHOD(Aerospike, removeBin, const Variant& php_key,
             const Array& bins, const Variant& options)
     {
         VMRegAnchor         _;
@@ -807,7 +1022,7 @@ namespace {
 
     /* {{{ proto int Aerospike::exists( array key, array &metadata [, array options] )
        Returns a record's metadata */
-    int64_t HHVM_METHOD(Aerospike, exists, const Array& php_key,
+    int64_t HHVM_METHOD(Aerospike, exists, const Variant& php_key,
             VRefParam metadata, const Variant& options)
     {
         VMRegAnchor         _;
@@ -851,72 +1066,370 @@ namespace {
     }
     /* }}} */
 
-    /* {{{ proto int Aerospike::existsMany( array keys, array &metadata [, array options] )
-       Returns metadata for a batch of records with NULL for non-existent ones */
-    int64_t HHVM_METHOD(Aerospike, existsMany, const Array& php_keys,
-            VRefParam metadata, const Variant& options)
+    /*
+     ************************************************************************************
+     * Checks the connection of an Aerospike object for the *Async() methods.
+     ************************************************************************************
+     */
+    static as_status check_async_connection(Aerospike *data, const char *method_p,
+            as_error& error)
     {
-        VMRegAnchor         _;
-        auto                data = Native::data<Aerospike>(this_);
-        as_error            error;
-        as_policy_batch     batch_policy;
-        PolicyManager       policy_manager;
-
-        as_error_init(&error);
+        as_error_reset(&error);
 
         if (!data->as_ref_p || !data->as_ref_p->as_p) {
-            as_error_update(&error, AEROSPIKE_ERR_CLIENT,
+            return as_error_update(&error, AEROSPIKE_ERR_CLIENT,
                     "Invalid aerospike connection object");
         } else if (!data->is_connected) {
-            as_error_update(&error, AEROSPIKE_ERR_CLUSTER,
-                    "existsMany: connection not established");
-        } else {
-            try {
-                BatchOpManager batch_op_manager(php_keys);
-                if (AEROSPIKE_OK == policy_manager.initPolicyManager(&batch_policy,
-                            "batch", &data->as_ref_p->as_p->config, error) &&
-                        AEROSPIKE_OK == policy_manager.set_policy(NULL,
-                            data->serializer_value, options, error)) {
-                    Array   php_metadata = Array::Create();
-                    batch_op_manager.execute_batch_exists(data->as_ref_p->as_p,
-                            php_metadata, batch_policy, error);
-                    metadata.assignIfRef(php_metadata);
-                }
-            } catch (const std::exception& e) {
-                as_error_update(&error, AEROSPIKE_ERR_CLIENT,
-                        "Failed to initialize batch operation");
-            }
+            return as_error_update(&error, AEROSPIKE_ERR_CLUSTER,
+                    "%s: connection not established", method_p);
         }
-
-        data->setError(error);
         return error.code;
     }
-    /* }}} */
 
-    /* {{{ proto string Aerospike::getKeyDigest( string ns, string set, int|string pk )
-       Helper which computes the digest that for a given key */
-    String HHVM_METHOD(Aerospike, getKeyDigest, const Variant& ns,
-            const Variant& set, const Variant& primary_key)
+    /* {{{ proto Awaitable Aerospike::getAsync( array key [, array filter [, array options ]] )
+       Reads a record from the cluster without blocking the request */
+    Object HHVM_METHOD(Aerospike, getAsync, const Variant& php_key,
+            const Variant& filter_bins, const Variant& options)
     {
         VMRegAnchor         _;
+        auto                data = Native::data<Aerospike>(this_);
         as_error            error;
         as_key              key;
-        char                *digest_p = NULL;
+        as_policy_read      read_policy;
+        bool                key_initialized = false;
+        PolicyManager       policy_manager;
+        std::vector<std::string> filter;
 
         as_error_init(&error);
 
-        get_digest_from_key(key, ns, set, primary_key, &digest_p, error);
-        if (error.code == AEROSPIKE_OK && *digest_p) {
-            as_key_destroy(&key);
-            String s = String((char*)digest_p, AS_DIGEST_VALUE_SIZE, CopyString);
-            free(digest_p);
-            return s;
-        }
-
-        return String();
-    }
-    /* }}} */
-
+        if (AEROSPIKE_OK == check_async_connection(data, "getAsync", error) &&
+                AEROSPIKE_OK == php_key_to_as_key(php_key, key, error)) {
+            key_initialized = true;
+            if (AEROSPIKE_OK == policy_manager.initPolicyManager(&read_policy,
+                        "read", &data->as_ref_p->as_p->config, error) &&
+                    AEROSPIKE_OK == policy_manager.set_policy(NULL,
+                        data->serializer_value, options, error)) {
+                if (!filter_bins.isNull() && !filter_bins.isArray()) {
+                    as_error_update(&error, AEROSPIKE_ERR_PARAM,
+                            "Filter bins must be of type an Array");
+                } else if (filter_bins.isArray()) {
+                    for (ArrayIter iter(filter_bins.toArray()); iter; ++iter) {
+                        if (!iter.second().isString()) {
+                            as_error_update(&error, AEROSPIKE_ERR_PARAM,
+                                    "Bin name in filter bins must be a string");
+                            break;
+                        }
+                        filter.push_back(iter.second().toString().toCppString());
+                    }
+                }
+            }
+        }
+
+        auto event_p = new AsyncGetEvent(data->as_ref_p);
+        if (error.code == AEROSPIKE_OK) {
+            event_p->set_key(key);
+            event_p->read_policy = read_policy;
+            event_p->has_filter = filter_bins.isArray();
+            event_p->filter_bins.swap(filter);
+        }
+        if (key_initialized) {
+            as_key_destroy(&key);
+        }
+        data->setError(error);
+
+        Object wait_handle{event_p->getWaitHandle()};
+        event_p->dispatch(error);
+        return wait_handle;
+    }
+    /* }}} */
+
+    /* {{{ proto Awaitable Aerospike::putAsync( array key, array record [, int ttl=0 [, array options ]] )
+       Writes a record to the cluster without blocking the request */
+    Object HHVM_METHOD(Aerospike, putAsync, const Variant& php_key,
+            const Array& php_rec, int64_t ttl, const Variant& options)
+    {
+        VMRegAnchor         _;
+        auto                data = Native::data<Aerospike>(this_);
+        as_error            error;
+        as_key              key;
+        as_record           rec;
+        StaticPoolManager   static_pool;
+        as_policy_write     write_policy;
+        bool                key_initialized = false;
+        bool                rec_initialized = false;
+        int16_t             serializer_option = 0;
+        PolicyManager       policy_manager;
+
+        as_error_init(&error);
+
+        if (AEROSPIKE_OK == check_async_connection(data, "putAsync", error) &&
+                AEROSPIKE_OK == php_key_to_as_key(php_key, key, error)) {
+            key_initialized = true;
+            if (AEROSPIKE_OK == policy_manager.initPolicyManager(&write_policy,
+                        "write", &data->as_ref_p->as_p->config, error) &&
+                    AEROSPIKE_OK == policy_manager.set_policy(&serializer_option,
+                        data->serializer_value, options, error)) {
+                rec_initialized = true;
+                if (AEROSPIKE_OK == php_record_to_as_record(php_rec, rec,
+                            ttl, static_pool, serializer_option, error)) {
+                    if (AEROSPIKE_OK == policy_manager.set_generation_value(&rec.gen,
+                                options, error)) {
+                        own_record_values(rec, error);
+                    }
+                }
+            }
+        }
+
+        auto event_p = new AsyncPutEvent(data->as_ref_p);
+        if (error.code == AEROSPIKE_OK) {
+            event_p->set_key(key);
+            event_p->write_policy = write_policy;
+            event_p->rec = rec;
+            event_p->rec_initialized = true;
+        } else if (rec_initialized) {
+            as_record_destroy(&rec);
+        }
+        if (key_initialized) {
+            as_key_destroy(&key);
+        }
+        data->setError(error);
+
+        Object wait_handle{event_p->getWaitHandle()};
+        event_p->dispatch(error);
+        return wait_handle;
+    }
+    /* }}} */
+
+    /* {{{ proto Awaitable Aerospike::operateAsync( array key, array operations [, array options ] )
+       Performs multiple operations on a record without blocking the request */
+    Object HHVM_METHOD(Aerospike, operateAsync, const Variant& php_key,
+            const Array& php_operations, const Variant& options)
+    {
+        VMRegAnchor         _;
+        auto                data = Native::data<Aerospike>(this_);
+        as_error            error;
+        as_key              key;
+        StaticPoolManager   static_pool;
+        as_operations       operations;
+        as_policy_operate   operate_policy;
+        int16_t             serializer_option = 0;
+        bool                key_initialized = false;
+        bool                operations_initialized = false;
+        PolicyManager       policy_manager;
+
+        as_error_init(&error);
+
+        if (AEROSPIKE_OK == check_async_connection(data, "operateAsync", error) &&
+                AEROSPIKE_OK == php_key_to_as_key(php_key, key, error)) {
+            key_initialized = true;
+            if (AEROSPIKE_OK == policy_manager.initPolicyManager(&operate_policy,
+                        "operate", &data->as_ref_p->as_p->config, error) &&
+                    AEROSPIKE_OK == policy_manager.set_policy(&serializer_option,
+                        data->serializer_value, options, error)) {
+                if (AEROSPIKE_OK == php_operations_to_as_operations(php_operations,
+                            operations, static_pool, serializer_option, error)) {
+                    operations_initialized = true;
+                    if (AEROSPIKE_OK == policy_manager.set_generation_value(&operations.gen,
+                                options, error) &&
+                            AEROSPIKE_OK == policy_manager.set_ttl_value(&operations.ttl,
+                                options, error)) {
+                        own_operations_values(operations, error);
+                    }
+                }
+            }
+        }
+
+        auto event_p = new AsyncOperateEvent(data->as_ref_p);
+        if (error.code == AEROSPIKE_OK) {
+            event_p->set_key(key);
+            event_p->operate_policy = operate_policy;
+            event_p->operations = operations;
+            event_p->operations_initialized = true;
+        } else if (operations_initialized) {
+            as_operations_destroy(&operations);
+        }
+        if (key_initialized) {
+            as_key_destroy(&key);
+        }
+        data->setError(error);
+
+        Object wait_handle{event_p->getWaitHandle()};
+        event_p->dispatch(error);
+        return wait_handle;
+    }
+    /* }}} */
+
+    /* {{{ proto Awaitable Aerospike::removeAsync( array key [, array options ] )
+       Removes a record from the cluster without blocking the request */
+    Object HHVM_METHOD(Aerospike, removeAsync, const Variant& php_key,
+            const Variant& options)
+    {
+        VMRegAnchor         _;
+        auto                data = Native::data<Aerospike>(this_);
+        as_error            error;
+        as_key              key;
+        as_policy_remove    remove_policy;
+        bool                key_initialized = false;
+        PolicyManager       policy_manager;
+
+        as_error_init(&error);
+
+        if (AEROSPIKE_OK == check_async_connection(data, "removeAsync", error) &&
+                AEROSPIKE_OK == php_key_to_as_key(php_key, key, error)) {
+            key_initialized = true;
+            if (AEROSPIKE_OK == policy_manager.initPolicyManager(&remove_policy,
+                        "remove", &data->as_ref_p->as_p->config, error) &&
+                    AEROSPIKE_OK == policy_manager.set_policy(NULL,
+                        data->serializer_value, options, error)) {
+                policy_manager.set_generation_value(&remove_policy.generation,
+                        options, error);
+            }
+        }
+
+        auto event_p = new AsyncRemoveEvent(data->as_ref_p);
+        if (error.code == AEROSPIKE_OK) {
+            event_p->set_key(key);
+            event_p->remove_policy = remove_policy;
+        }
+        if (key_initialized) {
+            as_key_destroy(&key);
+        }
+        data->setError(error);
+
+        Object wait_handle{event_p->getWaitHandle()};
+        event_p->dispatch(error);
+        return wait_handle;
+    }
+    /* }}} */
+
+    /* {{{ proto Awaitable Aerospike::existsAsync( array key [, array options ] )
+       Returns a record's metadata without blocking the request */
+    Object HHVM_METHOD(Aerospike, existsAsync, const Variant& php_key,
+            const Variant& options)
+    {
+        VMRegAnchor         _;
+        auto                data = Native::data<Aerospike>(this_);
+        as_error            error;
+        as_key              key;
+        as_policy_read      read_policy;
+        bool                key_initialized = false;
+        PolicyManager       policy_manager;
+
+        as_error_init(&error);
+
+        if (AEROSPIKE_OK == check_async_connection(data, "existsAsync", error) &&
+                AEROSPIKE_OK == php_key_to_as_key(php_key, key, error)) {
+            key_initialized = true;
+            if (AEROSPIKE_OK == policy_manager.initPolicyManager(&read_policy,
+                        "read", &data->as_ref_p->as_p->config, error)) {
+                policy_manager.set_policy(NULL, data->serializer_value,
+                        options, error);
+            }
+        }
+
+        auto event_p = new AsyncExistsEvent(data->as_ref_p);
+        if (error.code == AEROSPIKE_OK) {
+            event_p->set_key(key);
+            event_p->read_policy = read_policy;
+        }
+        if (key_initialized) {
+            as_key_destroy(&key);
+        }
+        data->setError(error);
+
+        Object wait_handle{event_p->getWaitHandle()};
+        event_p->dispatch(error);
+        return wait_handle;
+    }
+    /* }}} */
+
+    /* {{{ proto int Aerospike::existsMany( array keys, array &metadata [, array options [, array &statuses ]] )
+       Returns metadata for a batch of records with NULL for non-existent ones,
+       or only whether each record exists, depending on OPT_BATCH_EXISTS_FORMAT */
+    int64_t HHVM_METHOD(Aerospike, existsMany, const Array& php_keys,
+            VRefParam metadata, const Variant& options, VRefParam php_statuses)
+    {
+        VMRegAnchor         _;
+        auto                data = Native::data<Aerospike>(this_);
+        as_error            error;
+        as_policy_batch     batch_policy;
+        PolicyManager       policy_manager;
+        bool                positional = false;
+        batch_chunking      chunking;
+        int16_t             format = BATCH_EXISTS_METADATA;
+
+        as_error_init(&error);
+
+        if (!data->as_ref_p || !data->as_ref_p->as_p) {
+            as_error_update(&error, AEROSPIKE_ERR_CLIENT,
+                    "Invalid aerospike connection object");
+        } else if (!data->is_connected) {
+            as_error_update(&error, AEROSPIKE_ERR_CLUSTER,
+                    "existsMany: connection not established");
+        } else {
+            try {
+                BatchOpManager batch_op_manager(php_keys);
+                if (AEROSPIKE_OK == policy_manager.initPolicyManager(&batch_policy,
+                            "batch", &data->as_ref_p->as_p->config, error) &&
+                        AEROSPIKE_OK == policy_manager.set_policy(NULL,
+                            data->serializer_value, options, error) &&
+                        AEROSPIKE_OK == policy_manager.set_batch_positional(&positional,
+                            options, error) &&
+                        AEROSPIKE_OK == policy_manager.set_batch_chunking(&chunking,
+                            options, error) &&
+                        AEROSPIKE_OK == policy_manager.set_batch_exists_format(&format,
+                            options, error)) {
+                    Array   temp_php_statuses = Array::Create();
+                    if (format == BATCH_EXISTS_METADATA) {
+                        Array   php_metadata = Array::Create();
+                        batch_op_manager.execute_batch_exists(data->as_ref_p->as_p,
+                                php_metadata, temp_php_statuses, batch_policy, positional,
+                                chunking, error);
+                        metadata.assignIfRef(php_metadata);
+                    } else {
+                        Variant php_flags;
+                        batch_op_manager.execute_batch_exists_flags(data->as_ref_p->as_p,
+                                php_flags, temp_php_statuses, batch_policy, format,
+                                chunking, error);
+                        metadata.assignIfRef(php_flags);
+                    }
+                    php_statuses.assignIfRef(temp_php_statuses);
+                }
+            } catch (const std::exception& e) {
+                as_error_update(&error, AEROSPIKE_ERR_CLIENT,
+                        "Failed to initialize batch operation");
+            }
+        }
+
+        data->setError(error);
+        return error.code;
+    }
+    /* }}} */
+
+    /* {{{ proto string Aerospike::getKeyDigest( string ns, string set, int|string pk )
+       Helper which computes the digest that for a given key */
+    String HHVM_METHOD(Aerospike, getKeyDigest, const Variant& ns,
+            const Variant& set, const Variant& primary_key)
+    {
+        VMRegAnchor         _;
+        as_error            error;
+        as_key              key;
+        char                *digest_p = NULL;
+
+        as_error_init(&error);
+
+        get_digest_from_key(key, ns, set, primary_key, &digest_p, error);
+        if (error.code == AEROSPIKE_OK && *digest_p) {
+            as_key_destroy(&key);
+            String s = String((char*)digest_p, AS_DIGEST_VALUE_SIZE, CopyString);
+            free(digest_p);
+            return s;
+        }
+
+        return String();
+    }
+    /* }}} */
+
     /* {{{ proto int Aerospike::register( String path, String module [, int language = Aerospike::UDF_TYPE_LUA [, array options]] )
        Registers a UDF module with the Aerospike cluster */
     int64_t HHVM_METHOD(Aerospike, register, const Variant& path, const Variant& module,
@@ -1055,7 +1568,7 @@ namespace {
 
     /* {{{ proto int Aerospike::apply( array key, String module, String function [, array args [, mixed &returned [, array options]] )
        Applies a UDF to a record */
-    int64_t HHVM_METHOD(Aerospike, apply, const Array& php_key, const Variant& module, const Variant& function,
+    int64_t HHVM_METHOD(Aerospike, apply, const Variant& php_key, const Variant& module, const Variant& function,
             const Variant& args, VRefParam returned_value, const Variant& options)
     {
         VMRegAnchor         _;
@@ -1098,10 +1611,11 @@ namespace {
     }
     /* }}} */
 
-    /* {{{ proto int Aerospike::scan( string ns, string set, callback record_cb * [, array select [, array options ]] )
-       Returns all the records in a set to a callback method  */
+    /* {{{ proto int Aerospike::scan( string ns, string set, callback record_cb * [, array select [, array options [, array &cursor ]]] )
+       Returns all the records in a set to a callback method, or those of a
+       range of partitions, resuming from cursor if given one  */
     int64_t HHVM_METHOD(Aerospike, scan, const Variant &ns, const Variant &set, const Variant &function,
-            const Variant &bins, const Variant &options)
+            const Variant &bins, const Variant &options, VRefParam cursor)
     {
         VMRegAnchor         _;
         auto                data = Native::data<Aerospike>(this_);
@@ -1110,6 +1624,12 @@ namespace {
         as_policy_scan      scan_policy;
         bool                scan_initialized = false;
         PolicyManager       policy_manager;
+        uint32_t            buffer_size = SCAN_BUFFER_SIZE_DEFAULT;
+        scan_partition_range range;
+        Array               nodes_done = Array::Create();
+        Array               scan_nodes = Array::Create();
+        bool                scan_complete = false;
+        const Variant&      php_cursor = cursor;
 
         foreach_callback_user_udata      udata(function, error);
 
@@ -1130,9 +1650,45 @@ namespace {
                         "scan", &data->as_ref_p->as_p->config, error) &&
                     AEROSPIKE_OK == policy_manager.set_policy(NULL,
                         data->serializer_value, options, error) &&
-                    AEROSPIKE_OK == set_scan_policies(&scan, options, error)) {
-                aerospike_scan_foreach(data->as_ref_p->as_p, &error,
-                        &scan_policy, &scan, scan_query_callback, &udata);
+                    AEROSPIKE_OK == set_scan_policies(&scan, options, error) &&
+                    AEROSPIKE_OK == policy_manager.set_callback_chunk_size(&udata.chunk_size,
+                        options, error) &&
+                    AEROSPIKE_OK == policy_manager.set_scan_buffer_size(&buffer_size,
+                        options, error) &&
+                    AEROSPIKE_OK == policy_manager.set_scan_partitions(&range,
+                        options, error) &&
+                    AEROSPIKE_OK == policy_manager.set_max_records(&udata.max_records,
+                        options, error) &&
+                    (php_cursor.isNull() || AEROSPIKE_OK == parse_scan_cursor(php_cursor,
+                        &scan, range, nodes_done, scan_nodes, error))) {
+                if (range.is_set) {
+                    scan_partitions(data->as_ref_p->as_p, &scan_policy, &scan, range,
+                            nodes_done, scan_nodes, scan_complete, udata, error);
+                } else if (scan.concurrent) {
+                    /*
+                     * The nodes are scanned by several C client threads, which
+                     * only hand the records over to this thread, where the
+                     * callback is run.
+                     */
+                    aerospike   *as_p = data->as_ref_p->as_p;
+                    RecordStream stream;
+                    auto run_scan = [&] (as_error& job_error) {
+                        aerospike_scan_foreach(as_p, &job_error, &scan_policy,
+                                &scan, RecordStream::callback, &stream);
+                    };
+                    if (AEROSPIKE_OK == stream.start(data->as_ref_p, buffer_size,
+                                udata.max_records, run_scan, error)) {
+                        stream.foreach(scan_query_callback, &udata, error);
+                    }
+                } else {
+                    aerospike_scan_foreach(data->as_ref_p->as_p, &error,
+                            &scan_policy, &scan, scan_query_callback, &udata);
+                }
+                finish_scan_query(udata);
+                if (range.is_set) {
+                    cursor.assignIfRef(create_scan_cursor(&scan, range, nodes_done,
+                                scan_nodes, scan_complete));
+                }
             }
         }
 
@@ -1145,8 +1701,54 @@ namespace {
     }
     /* }}} */
 
+    /* {{{ proto AerospikeScanIterator Aerospike::scanIterator( string ns, string set [, array select [, array options ]] )
+       Returns an iterator over the records in a set, buffering up to
+       OPT_SCAN_BUFFER_SIZE records ahead of the one being iterated */
+    Variant HHVM_METHOD(Aerospike, scanIterator, const Variant &ns, const Variant &set,
+            const Variant &bins, const Variant &options)
+    {
+        VMRegAnchor         _;
+        auto                data = Native::data<Aerospike>(this_);
+        as_error            error;
+        as_policy_scan      scan_policy;
+        PolicyManager       policy_manager;
+        uint32_t            buffer_size = SCAN_BUFFER_SIZE_DEFAULT;
+        uint64_t            max_records = 0;
+        Variant             php_iterator = init_null();
+
+        as_error_init(&error);
+
+        if (!data->as_ref_p || !data->as_ref_p->as_p) {
+            as_error_update(&error, AEROSPIKE_ERR_CLIENT,
+                    "Invalid aerospike connection object");
+        } else if (!data->is_connected) {
+            as_error_update(&error, AEROSPIKE_ERR_CLUSTER,
+                    "scanIterator: connection not established");
+        } else if (AEROSPIKE_OK == policy_manager.initPolicyManager(&scan_policy,
+                    "scan", &data->as_ref_p->as_p->config, error) &&
+                AEROSPIKE_OK == policy_manager.set_policy(NULL,
+                    data->serializer_value, options, error) &&
+                AEROSPIKE_OK == policy_manager.set_scan_buffer_size(&buffer_size,
+                    options, error) &&
+                AEROSPIKE_OK == policy_manager.set_max_records(&max_records,
+                    options, error)) {
+            Object iterator = create_object_only(s_AerospikeScanIterator);
+            auto iterator_data = Native::data<AerospikeScanIterator>(iterator.get());
+            if (AEROSPIKE_OK == iterator_data->init(Object(this_), data->as_ref_p,
+                        ns, set, bins, options, scan_policy, buffer_size, max_records, error)) {
+                php_iterator = iterator;
+            }
+        }
+
+        data->setError(error);
+        return php_iterator;
+    }
+    /* }}} */
+
     /* {{{ proto int Aerospike::scanApply( string ns, string set, string module, * string function, array args, int &scan_id [, array options ] )
-       Applies a record UDF to each record of a set using a background scan  */
+       Applies a record UDF to each record of a set using a background scan,
+       returning as soon as the scan is started. Use scanInfo() or scanJob()
+       to follow the scan */
     int64_t HHVM_METHOD(Aerospike, scanApply, const Variant &ns, const Variant &set, const Variant &module,
             const Variant &function, const Variant &args, VRefParam scan_id, const Variant &options)
     {
@@ -1157,12 +1759,9 @@ namespace {
         uint64_t            _scan_id = 0;
         StaticPoolManager   static_pool;
         as_policy_scan      scan_policy;
-        as_policy_info      info_policy;
         bool                scan_initialized = false;
-        bool                is_wait = true;
         int16_t             serializer_type = SERIALIZER_PHP;
         PolicyManager       policy_manager_scan;
-        PolicyManager       policy_manager_info;
 
         as_error_init(&error);
 
@@ -1187,13 +1786,6 @@ namespace {
                 if (AEROSPIKE_OK == aerospike_scan_background(data->as_ref_p->as_p, &error,
                             &scan_policy, &scan, &_scan_id)) {
                     scan_id.assignIfRef((int64_t)_scan_id);
-                    //Background scan started, now we can check the status
-                    if (is_wait && AEROSPIKE_OK == policy_manager_info.initPolicyManager(&info_policy,
-                                "info", &data->as_ref_p->as_p->config, error) &&
-                            AEROSPIKE_OK == policy_manager_scan.set_policy(NULL,
-                                data->serializer_value, options, error)) {
-                        aerospike_scan_wait(data->as_ref_p->as_p, &error, &info_policy, _scan_id, 0);
-                    }
                 }
             }
         }
@@ -1239,11 +1831,7 @@ namespace {
             }
             if (AEROSPIKE_OK == aerospike_scan_info(data->as_ref_p->as_p, &error,
                         &info_policy, _scan_id, &_scan_info)) {
-                Array php_scan_info = Array::Create();
-                php_scan_info.set(s_progress_pct, (int64_t)_scan_info.progress_pct);
-                php_scan_info.set(s_records_scanned, (int64_t)_scan_info.records_scanned);
-                php_scan_info.set(s_status, (int64_t)_scan_info.status);
-                scan_info.assignIfRef(php_scan_info);
+                scan_info.assignIfRef(as_scan_info_to_php_array(_scan_info));
             }
         }
 
@@ -1252,6 +1840,48 @@ namespace {
     }
     /* }}} */
 
+    /* {{{ proto AerospikeScanJob Aerospike::scanJob ( int scan_id [, array $options ] )
+       Returns a handle on a background scan triggered by scanApply(), to
+       poll its status or wait for it with a timeout */
+    Variant HHVM_METHOD(Aerospike, scanJob, const Variant &scan_id, const Variant &options)
+    {
+        VMRegAnchor         _;
+        auto                data = Native::data<Aerospike>(this_);
+        as_error            error;
+        as_policy_info      info_policy;
+        PolicyManager       policy_manager;
+        Variant             php_job = init_null();
+
+        as_error_init(&error);
+
+        if (!data->as_ref_p || !data->as_ref_p->as_p) {
+            as_error_update(&error, AEROSPIKE_ERR_CLIENT,
+                    "Invalid aerospike connection object");
+        } else if (!data->is_connected) {
+            as_error_update(&error, AEROSPIKE_ERR_CLUSTER,
+                    "scanJob: connection not established");
+        } else if (!scan_id.isInteger() || scan_id.toInt64() == 0) {
+            /*
+             * Scan ids are uint64, the ones above INT64_MAX reach PHP as
+             * negative integers.
+             */
+            as_error_update(&error, AEROSPIKE_ERR_PARAM,
+                    "scan_id argument is invalid");
+        } else if (AEROSPIKE_OK == policy_manager.initPolicyManager(&info_policy,
+                    "info", &data->as_ref_p->as_p->config, error) &&
+                AEROSPIKE_OK == policy_manager.set_policy(NULL,
+                    data->serializer_value, options, error)) {
+            Object job = create_object_only(s_AerospikeScanJob);
+            Native::data<AerospikeScanJob>(job.get())->init(Object(this_),
+                    (uint64_t) scan_id.toInt64(), info_policy);
+            php_job = job;
+        }
+
+        data->setError(error);
+        return php_job;
+    }
+    /* }}} */
+
     /* {{{ proto array Aerospike::predicateEquals( string bin, int|string val )
        Helper which builds the 'WHERE EQUALS' predicate */
     Variant HHVM_STATIC_METHOD(Aerospike, predicateEquals, const Variant &bin, const Variant &value)
@@ -1343,6 +1973,7 @@ namespace {
         as_policy_query     query_policy;
         bool                query_initialized = false;
         PolicyManager       policy_manager;
+        uint32_t            buffer_size = SCAN_BUFFER_SIZE_DEFAULT;
 
         foreach_callback_user_udata      udata(function, error);
 
@@ -1362,9 +1993,29 @@ namespace {
             if (AEROSPIKE_OK == policy_manager.initPolicyManager(&query_policy,
                         "query", &data->as_ref_p->as_p->config, error) &&
                     AEROSPIKE_OK == policy_manager.set_policy(NULL,
-                        data->serializer_value, options, error)) {
-                aerospike_query_foreach(data->as_ref_p->as_p, &error,
-                        &query_policy, &query, scan_query_callback, &udata);
+                        data->serializer_value, options, error) &&
+                    AEROSPIKE_OK == policy_manager.set_callback_chunk_size(&udata.chunk_size,
+                        options, error) &&
+                    AEROSPIKE_OK == policy_manager.set_scan_buffer_size(&buffer_size,
+                        options, error) &&
+                    AEROSPIKE_OK == policy_manager.set_max_records(&udata.max_records,
+                        options, error)) {
+                /*
+                 * The nodes are queried by several C client threads, which
+                 * only hand the records over to this thread, where the
+                 * callback is run.
+                 */
+                aerospike   *as_p = data->as_ref_p->as_p;
+                RecordStream stream;
+                auto run_query = [&] (as_error& job_error) {
+                    aerospike_query_foreach(as_p, &job_error, &query_policy,
+                            &query, RecordStream::callback, &stream);
+                };
+                if (AEROSPIKE_OK == stream.start(data->as_ref_p, buffer_size,
+                            udata.max_records, run_query, error)) {
+                    stream.foreach(scan_query_callback, &udata, error);
+                }
+                finish_scan_query(udata);
             }
         }
 
@@ -1377,6 +2028,51 @@ namespace {
     }
     /* }}} */
 
+    /* {{{ proto AerospikeQueryIterator Aerospike::queryIterator( string ns, string set, array where [, array select [, array options ]] )
+       Returns an iterator over the records matching the where predicate,
+       buffering up to OPT_SCAN_BUFFER_SIZE records ahead of the one being
+       iterated */
+    Variant HHVM_METHOD(Aerospike, queryIterator, const Variant &ns, const Variant &set,
+            const Variant &where, const Variant &bins, const Variant &options)
+    {
+        VMRegAnchor         _;
+        auto                data = Native::data<Aerospike>(this_);
+        as_error            error;
+        as_policy_query     query_policy;
+        PolicyManager       policy_manager;
+        uint32_t            buffer_size = SCAN_BUFFER_SIZE_DEFAULT;
+        uint64_t            max_records = 0;
+        Variant             php_iterator = init_null();
+
+        as_error_init(&error);
+
+        if (!data->as_ref_p || !data->as_ref_p->as_p) {
+            as_error_update(&error, AEROSPIKE_ERR_CLIENT,
+                    "Invalid aerospike connection object");
+        } else if (!data->is_connected) {
+            as_error_update(&error, AEROSPIKE_ERR_CLUSTER,
+                    "queryIterator: connection not established");
+        } else if (AEROSPIKE_OK == policy_manager.initPolicyManager(&query_policy,
+                    "query", &data->as_ref_p->as_p->config, error) &&
+                AEROSPIKE_OK == policy_manager.set_policy(NULL,
+                    data->serializer_value, options, error) &&
+                AEROSPIKE_OK == policy_manager.set_scan_buffer_size(&buffer_size,
+                    options, error) &&
+                AEROSPIKE_OK == policy_manager.set_max_records(&max_records,
+                    options, error)) {
+            Object iterator = create_object_only(s_AerospikeQueryIterator);
+            auto iterator_data = Native::data<AerospikeQueryIterator>(iterator.get());
+            if (AEROSPIKE_OK == iterator_data->init(Object(this_), data->as_ref_p,
+                        ns, set, where, bins, query_policy, buffer_size, max_records, error)) {
+                php_iterator = iterator;
+            }
+        }
+
+        data->setError(error);
+        return php_iterator;
+    }
+    /* }}} */
+
     /* {{{ proto int Aerospike::aggregate( string ns, string set, array where, string module, string function, array args, mixed &returned [, array options ] )
        Applies a stream UDF to the records matching a query and aggregates the results  */
     int64_t HHVM_METHOD(Aerospike, aggregate, const Variant &ns, const Variant &set, const Variant &where,
@@ -1435,7 +2131,7 @@ namespace {
        Displays the error message associated with the last operation */
     int64_t HHVM_METHOD(Aerospike, errorno)
     {
-        return Native::data<Aerospike>(this_)->getError().code;
+        return Native::data<Aerospike>(this_)->getErrorCode();
     }
     /* }}} */
 
@@ -1443,7 +2139,291 @@ namespace {
        Displays the status code associated with the last operation */
     String HHVM_METHOD(Aerospike, error)
     {
-        return Native::data<Aerospike>(this_)->getError().message;
+        return Native::data<Aerospike>(this_)->getErrorMessage();
+    }
+    /* }}} */
+
+    /* {{{ proto mixed AerospikeBatchIterator::current( void )
+       Returns the current record, or NULL if it does not exist or could not
+       be read */
+    Variant HHVM_METHOD(AerospikeBatchIterator, current)
+    {
+        VMRegAnchor _;
+        return Native::data<AerospikeBatchIterator>(this_)->current();
+    }
+    /* }}} */
+
+    /* {{{ proto mixed AerospikeBatchIterator::key( void )
+       Returns the key of the current record within the keys array */
+    Variant HHVM_METHOD(AerospikeBatchIterator, key)
+    {
+        return Native::data<AerospikeBatchIterator>(this_)->key();
+    }
+    /* }}} */
+
+    /* {{{ proto void AerospikeBatchIterator::next( void )
+       Moves to the next record */
+    void HHVM_METHOD(AerospikeBatchIterator, next)
+    {
+        Native::data<AerospikeBatchIterator>(this_)->next();
+    }
+    /* }}} */
+
+    /* {{{ proto bool AerospikeBatchIterator::valid( void )
+       Checks whether a record remains, waiting for the next chunk if needed */
+    bool HHVM_METHOD(AerospikeBatchIterator, valid)
+    {
+        return Native::data<AerospikeBatchIterator>(this_)->valid();
+    }
+    /* }}} */
+
+    /* {{{ proto int AerospikeBatchIterator::errorno( void )
+       Displays the status code of the first error met by the iterator */
+    int64_t HHVM_METHOD(AerospikeBatchIterator, errorno)
+    {
+        return Native::data<AerospikeBatchIterator>(this_)->getErrorCode();
+    }
+    /* }}} */
+
+    /* {{{ proto string AerospikeBatchIterator::error( void )
+       Displays the message of the first error met by the iterator */
+    String HHVM_METHOD(AerospikeBatchIterator, error)
+    {
+        return Native::data<AerospikeBatchIterator>(this_)->getErrorMessage();
+    }
+    /* }}} */
+
+    /* {{{ proto mixed AerospikeScanIterator::current( void )
+       Returns the current record, or NULL if it could not be converted */
+    Variant HHVM_METHOD(AerospikeScanIterator, current)
+    {
+        VMRegAnchor _;
+        return Native::data<AerospikeScanIterator>(this_)->current();
+    }
+    /* }}} */
+
+    /* {{{ proto mixed AerospikeScanIterator::key( void )
+       Returns the no. of the current record within the scan */
+    Variant HHVM_METHOD(AerospikeScanIterator, key)
+    {
+        VMRegAnchor _;
+        return Native::data<AerospikeScanIterator>(this_)->key();
+    }
+    /* }}} */
+
+    /* {{{ proto void AerospikeScanIterator::next( void )
+       Moves to the next record */
+    void HHVM_METHOD(AerospikeScanIterator, next)
+    {
+        VMRegAnchor _;
+        Native::data<AerospikeScanIterator>(this_)->next();
+    }
+    /* }}} */
+
+    /* {{{ proto bool AerospikeScanIterator::valid( void )
+       Checks whether a record remains, waiting for the scan if needed */
+    bool HHVM_METHOD(AerospikeScanIterator, valid)
+    {
+        VMRegAnchor _;
+        return Native::data<AerospikeScanIterator>(this_)->valid();
+    }
+    /* }}} */
+
+    /* {{{ proto void AerospikeScanIterator::close( void )
+       Stops the scan and frees the buffered records */
+    void HHVM_METHOD(AerospikeScanIterator, close)
+    {
+        Native::data<AerospikeScanIterator>(this_)->close();
+    }
+    /* }}} */
+
+    /* {{{ proto int AerospikeScanIterator::errorno( void )
+       Displays the status code of the first error met by the iterator */
+    int64_t HHVM_METHOD(AerospikeScanIterator, errorno)
+    {
+        return Native::data<AerospikeScanIterator>(this_)->getErrorCode();
+    }
+    /* }}} */
+
+    /* {{{ proto string AerospikeScanIterator::error( void )
+       Displays the message of the first error met by the iterator */
+    String HHVM_METHOD(AerospikeScanIterator, error)
+    {
+        return Native::data<AerospikeScanIterator>(this_)->getErrorMessage();
+    }
+    /* }}} */
+
+    /* {{{ proto mixed AerospikeQueryIterator::current( void )
+       Returns the current record, or NULL if it could not be converted */
+    Variant HHVM_METHOD(AerospikeQueryIterator, current)
+    {
+        VMRegAnchor _;
+        return Native::data<AerospikeQueryIterator>(this_)->current();
+    }
+    /* }}} */
+
+    /* {{{ proto mixed AerospikeQueryIterator::key( void )
+       Returns the no. of the current record within the query */
+    Variant HHVM_METHOD(AerospikeQueryIterator, key)
+    {
+        VMRegAnchor _;
+        return Native::data<AerospikeQueryIterator>(this_)->key();
+    }
+    /* }}} */
+
+    /* {{{ proto void AerospikeQueryIterator::next( void )
+       Moves to the next record */
+    void HHVM_METHOD(AerospikeQueryIterator, next)
+    {
+        VMRegAnchor _;
+        Native::data<AerospikeQueryIterator>(this_)->next();
+    }
+    /* }}} */
+
+    /* {{{ proto bool AerospikeQueryIterator::valid( void )
+       Checks whether a record remains, waiting for the query if needed */
+    bool HHVM_METHOD(AerospikeQueryIterator, valid)
+    {
+        VMRegAnchor _;
+        return Native::data<AerospikeQueryIterator>(this_)->valid();
+    }
+    /* }}} */
+
+    /* {{{ proto void AerospikeQueryIterator::close( void )
+       Stops the query and frees the buffered records */
+    void HHVM_METHOD(AerospikeQueryIterator, close)
+    {
+        Native::data<AerospikeQueryIterator>(this_)->close();
+    }
+    /* }}} */
+
+    /* {{{ proto int AerospikeQueryIterator::errorno( void )
+       Displays the status code of the first error met by the iterator */
+    int64_t HHVM_METHOD(AerospikeQueryIterator, errorno)
+    {
+        return Native::data<AerospikeQueryIterator>(this_)->getErrorCode();
+    }
+    /* }}} */
+
+    /* {{{ proto string AerospikeQueryIterator::error( void )
+       Displays the message of the first error met by the iterator */
+    String HHVM_METHOD(AerospikeQueryIterator, error)
+    {
+        return Native::data<AerospikeQueryIterator>(this_)->getErrorMessage();
+    }
+    /* }}} */
+
+    /* {{{ proto int AerospikeScanJob::getId( void )
+       Returns the id of the background scan */
+    int64_t HHVM_METHOD(AerospikeScanJob, getId)
+    {
+        return Native::data<AerospikeScanJob>(this_)->getId();
+    }
+    /* }}} */
+
+    /* {{{ proto int AerospikeScanJob::info( array &info )
+       Gets the status of the background scan once, without waiting */
+    int64_t HHVM_METHOD(AerospikeScanJob, info, VRefParam scan_info)
+    {
+        VMRegAnchor         _;
+        auto                job = Native::data<AerospikeScanJob>(this_);
+        as_scan_info        _scan_info;
+
+        if (AEROSPIKE_OK == job->info(_scan_info)) {
+            scan_info.assignIfRef(as_scan_info_to_php_array(_scan_info));
+        }
+        return job->getErrorCode();
+    }
+    /* }}} */
+
+    /* {{{ proto int AerospikeScanJob::wait( [ int timeout_ms = 0 [, int interval_ms = 100 ]] )
+       Polls the status of the background scan until it completes, giving up
+       with ERR_TIMEOUT after timeout_ms, unless it is 0 */
+    int64_t HHVM_METHOD(AerospikeScanJob, wait, int64_t timeout_ms, int64_t interval_ms)
+    {
+        VMRegAnchor _;
+        return Native::data<AerospikeScanJob>(this_)->wait(timeout_ms, interval_ms);
+    }
+    /* }}} */
+
+    /* {{{ proto int AerospikeScanJob::errorno( void )
+       Displays the status code of the last call on the job */
+    int64_t HHVM_METHOD(AerospikeScanJob, errorno)
+    {
+        return Native::data<AerospikeScanJob>(this_)->getErrorCode();
+    }
+    /* }}} */
+
+    /* {{{ proto string AerospikeScanJob::error( void )
+       Displays the message of the last call on the job */
+    String HHVM_METHOD(AerospikeScanJob, error)
+    {
+        return Native::data<AerospikeScanJob>(this_)->getErrorMessage();
+    }
+    /* }}} */
+
+    /* {{{ proto AerospikeKey::__construct( mixed ns, mixed set, mixed key [, bool digest=false ] )
+       Initializes an immutable key and computes its digest, for reuse in
+       place of the key array of any Aerospike method */
+    void HHVM_METHOD(AerospikeKey, __construct, const Variant& ns, const Variant& set,
+            const Variant& key, bool digest)
+    {
+        auto                key_data = Native::data<AerospikeKey>(this_);
+        as_error            error;
+
+        as_error_init(&error);
+
+        if (AEROSPIKE_OK != key_data->init(ns, set, key, digest, error)) {
+            SystemLib::throwInvalidArgumentExceptionObject(error.message);
+        }
+    }
+    /* }}} */
+
+    /* {{{ proto array AerospikeKey::toArray( void )
+       Returns the key in the array form returned by Aerospike::initKey() */
+    Array HHVM_METHOD(AerospikeKey, toArray)
+    {
+        auto                key_data = Native::data<AerospikeKey>(this_);
+        Array               php_key = Array::Create();
+
+        if (!key_data->is_initialized) {
+            return php_key;
+        }
+
+        php_key.set(s_ns, String(key_data->key.ns));
+        php_key.set(s_set, String(key_data->key.set));
+        if (key_data->is_digest || !key_data->key.valuep) {
+            php_key.set(s_digest, String((const char *) key_data->key.digest.value,
+                        AS_DIGEST_VALUE_SIZE, CopyString));
+        } else if (as_val_type((as_val *) key_data->key.valuep) == AS_INTEGER) {
+            php_key.set(s_key, key_data->key.value.integer.value);
+        } else {
+            php_key.set(s_key, String(key_data->key.value.string.value,
+                        key_data->key.value.string.len, CopyString));
+        }
+        return php_key;
+    }
+    /* }}} */
+
+    /* {{{ proto AerospikePolicy::__construct( Aerospike db, array options )
+       Precompiles the options array against the policy defaults of db, for
+       reuse in place of the options array of any Aerospike method */
+    void HHVM_METHOD(AerospikePolicy, __construct, const Object& db, const Array& options)
+    {
+        auto                data = Native::data<Aerospike>(db.get());
+        auto                policy_data = Native::data<AerospikePolicy>(this_);
+        as_error            error;
+
+        as_error_init(&error);
+
+        if (!data->as_ref_p || !data->as_ref_p->as_p) {
+            as_error_update(&error, AEROSPIKE_ERR_CLIENT,
+                    "Invalid aerospike connection object");
+        } else {
+            policy_data->compile(&data->as_ref_p->as_p->config, options, error);
+        }
+
+        data->setError(error);
     }
     /* }}} */
 
@@ -1471,13 +2451,23 @@ namespace {
                 HHVM_ME(Aerospike, put);
                 HHVM_ME(Aerospike, get);
                 HHVM_ME(Aerospike, getMany);
+                HHVM_ME(Aerospike, getManyIterator);
+                HHVM_ME(Aerospike, selectMany);
+                HHVM_ME(Aerospike, putMany);
                 HHVM_ME(Aerospike, addIndex);
                 HHVM_ME(Aerospike, dropIndex);
                 HHVM_ME(Aerospike, operate);
+                HHVM_ME(Aerospike, operateMany);
                 HHVM_ME(Aerospike, remove);
                 HHVM_ME(Aerospike, removeBin);
+                HHVM_ME(Aerospike, removeMany);
                 HHVM_ME(Aerospike, exists);
                 HHVM_ME(Aerospike, existsMany);
+                HHVM_ME(Aerospike, getAsync);
+                HHVM_ME(Aerospike, putAsync);
+                HHVM_ME(Aerospike, operateAsync);
+                HHVM_ME(Aerospike, removeAsync);
+                HHVM_ME(Aerospike, existsAsync);
                 HHVM_ME(Aerospike, getKeyDigest);
                 HHVM_ME(Aerospike, register);
                 HHVM_ME(Aerospike, deregister);
@@ -1485,20 +2475,61 @@ namespace {
                 HHVM_ME(Aerospike, listRegistered);
                 HHVM_ME(Aerospike, apply);
                 HHVM_ME(Aerospike, scan);
+                HHVM_ME(Aerospike, scanIterator);
                 HHVM_ME(Aerospike, scanApply);
                 HHVM_ME(Aerospike, scanInfo);
+                HHVM_ME(Aerospike, scanJob);
                 HHVM_STATIC_ME(Aerospike, predicateEquals);
                 HHVM_STATIC_ME(Aerospike, predicateContains);
                 HHVM_STATIC_ME(Aerospike, predicateBetween);
                 HHVM_STATIC_ME(Aerospike, predicateRange);
                 HHVM_ME(Aerospike, query);
+                HHVM_ME(Aerospike, queryIterator);
                 HHVM_ME(Aerospike, aggregate);
                 HHVM_ME(Aerospike, errorno);
                 HHVM_ME(Aerospike, error);
                 HHVM_STATIC_ME(Aerospike, setSerializer);
                 HHVM_STATIC_ME(Aerospike, setDeserializer);
                 Native::registerNativeDataInfo<Aerospike>(s_Aerospike.get());
-                pthread_rwlock_init(&connection_mutex, NULL);
+                HHVM_ME(AerospikeKey, __construct);
+                HHVM_ME(AerospikeKey, toArray);
+                Native::registerNativeDataInfo<AerospikeKey>(s_AerospikeKey.get(),
+                        Native::NDIFlags::NO_COPY);
+                HHVM_ME(AerospikeBatchIterator, current);
+                HHVM_ME(AerospikeBatchIterator, key);
+                HHVM_ME(AerospikeBatchIterator, next);
+                HHVM_ME(AerospikeBatchIterator, valid);
+                HHVM_ME(AerospikeBatchIterator, errorno);
+                HHVM_ME(AerospikeBatchIterator, error);
+                Native::registerNativeDataInfo<AerospikeBatchIterator>(
+                        s_AerospikeBatchIterator.get(), Native::NDIFlags::NO_COPY);
+                HHVM_ME(AerospikeScanIterator, current);
+                HHVM_ME(AerospikeScanIterator, key);
+                HHVM_ME(AerospikeScanIterator, next);
+                HHVM_ME(AerospikeScanIterator, valid);
+                HHVM_ME(AerospikeScanIterator, close);
+                HHVM_ME(AerospikeScanIterator, errorno);
+                HHVM_ME(AerospikeScanIterator, error);
+                Native::registerNativeDataInfo<AerospikeScanIterator>(
+                        s_AerospikeScanIterator.get(), Native::NDIFlags::NO_COPY);
+                HHVM_ME(AerospikeQueryIterator, current);
+                HHVM_ME(AerospikeQueryIterator, key);
+                HHVM_ME(AerospikeQueryIterator, next);
+                HHVM_ME(AerospikeQueryIterator, valid);
+                HHVM_ME(AerospikeQueryIterator, close);
+                HHVM_ME(AerospikeQueryIterator, errorno);
+                HHVM_ME(AerospikeQueryIterator, error);
+                Native::registerNativeDataInfo<AerospikeQueryIterator>(
+                        s_AerospikeQueryIterator.get(), Native::NDIFlags::NO_COPY);
+                HHVM_ME(AerospikeScanJob, getId);
+                HHVM_ME(AerospikeScanJob, info);
+                HHVM_ME(AerospikeScanJob, wait);
+                HHVM_ME(AerospikeScanJob, errorno);
+                HHVM_ME(AerospikeScanJob, error);
+                Native::registerNativeDataInfo<AerospikeScanJob>(
+                        s_AerospikeScanJob.get(), Native::NDIFlags::NO_COPY);
+                HHVM_ME(AerospikePolicy, __construct);
+                Native::registerNativeDataInfo<AerospikePolicy>(s_AerospikePolicy.get());
 
                 loadSystemlib();
             }
@@ -1558,37 +2589,11 @@ namespace {
             void moduleShutdown() override
             {
                 as_error error;
-                aerospike_ref *map_entry = NULL;
 
                 as_error_init(&error);
 
-                pthread_rwlock_wrlock(&connection_mutex);
-                auto it = persistent_list.begin();
-                while (it != persistent_list.end()) {
-                    map_entry = it->second;
-
-                    if (map_entry) {
-                        if (map_entry->ref_host_entry > 1) {
-                            map_entry->ref_host_entry--;
-                        } else {
-                            if (map_entry->as_p) {
-                                aerospike_close(map_entry->as_p, &error);
-                                aerospike_destroy(map_entry->as_p);
-                            }
-                            map_entry->ref_host_entry = 0;
-                            map_entry->as_p = NULL;
-                            if (map_entry) {
-                                free(map_entry);
-                            }
-                            map_entry = NULL;
-                        }
-                    } else {
-                        //Invalid aerospike object
-                    }
-                    ++it;
-                }
-                persistent_list.erase(persistent_list.begin(), persistent_list.end());
-                pthread_rwlock_wrlock(&connection_mutex);
+                async_command_pool.shutdown();
+                persistent_registry.close_all(error);
             }
             //free_shm_key();
     } s_aerospike_extension;
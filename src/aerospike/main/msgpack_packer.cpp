@@ -0,0 +1,265 @@
+#include "msgpack_packer.h"
+
+namespace HPHP {
+
+    /*
+     *******************************************************************************************
+     * Destructor for MsgpackPacker, frees the buffer if it was not released
+     * to an as_bytes.
+     *******************************************************************************************
+     */
+    MsgpackPacker::~MsgpackPacker()
+    {
+        reset();
+    }
+
+    /*
+     *******************************************************************************************
+     * Frees the buffer, if any, and makes the packer ready to pack a new value.
+     *******************************************************************************************
+     */
+    void MsgpackPacker::reset()
+    {
+        if (buffer_p) {
+            free(buffer_p);
+        }
+        buffer_p = NULL;
+        size = 0;
+        capacity = 0;
+        failed = false;
+    }
+
+    /*
+     *******************************************************************************************
+     * Makes sure the buffer can take length more bytes, doubling its capacity
+     * as needed.
+     *
+     * @param length        No. of bytes about to be written.
+     * @return true if success. Otherwise false.
+     *******************************************************************************************
+     */
+    bool MsgpackPacker::reserve(uint32_t length)
+    {
+        if (failed) {
+            return false;
+        }
+        if (size + length <= capacity) {
+            return true;
+        }
+
+        uint32_t new_capacity = capacity ? capacity : MSGPACK_PACKER_INITIAL_CAPACITY;
+        while (new_capacity < size + length) {
+            new_capacity *= 2;
+        }
+
+        uint8_t *new_buffer_p = (uint8_t *) realloc(buffer_p, new_capacity);
+        if (!new_buffer_p) {
+            failed = true;
+            return false;
+        }
+        buffer_p = new_buffer_p;
+        capacity = new_capacity;
+        return true;
+    }
+
+    void MsgpackPacker::write_byte(uint8_t byte)
+    {
+        if (reserve(1)) {
+            buffer_p[size++] = byte;
+        }
+    }
+
+    void MsgpackPacker::write_bytes(const void *bytes_p, uint32_t length)
+    {
+        if (length && reserve(length)) {
+            memcpy(buffer_p + size, bytes_p, length);
+            size += length;
+        }
+    }
+
+    void MsgpackPacker::write_be16(uint16_t value)
+    {
+        uint8_t be[2] = { (uint8_t) (value >> 8), (uint8_t) value };
+        write_bytes(be, sizeof(be));
+    }
+
+    void MsgpackPacker::write_be32(uint32_t value)
+    {
+        uint8_t be[4] = { (uint8_t) (value >> 24), (uint8_t) (value >> 16),
+            (uint8_t) (value >> 8), (uint8_t) value };
+        write_bytes(be, sizeof(be));
+    }
+
+    void MsgpackPacker::write_be64(uint64_t value)
+    {
+        write_be32((uint32_t) (value >> 32));
+        write_be32((uint32_t) value);
+    }
+
+    /*
+     *******************************************************************************************
+     * Packs the header of a raw (string/bytes) value of given length.
+     * Uses the raw family (fixraw, raw 16, raw 32) understood by every
+     * server version.
+     *******************************************************************************************
+     */
+    void MsgpackPacker::pack_raw_header(uint32_t length)
+    {
+        if (length < 32) {
+            write_byte(0xa0 | (uint8_t) length);
+        } else if (length < 65536) {
+            write_byte(0xda);
+            write_be16((uint16_t) length);
+        } else {
+            write_byte(0xdb);
+            write_be32(length);
+        }
+    }
+
+    void MsgpackPacker::pack_nil()
+    {
+        write_byte(0xc0);
+    }
+
+    /*
+     *******************************************************************************************
+     * Packs an integer using the smallest msgpack representation that holds it.
+     *******************************************************************************************
+     */
+    void MsgpackPacker::pack_int64(int64_t value)
+    {
+        if (value < -(1LL << 5)) {
+            if (value < -(1LL << 15)) {
+                if (value < -(1LL << 31)) {
+                    write_byte(0xd3);
+                    write_be64((uint64_t) value);
+                } else {
+                    write_byte(0xd2);
+                    write_be32((uint32_t) value);
+                }
+            } else if (value < -(1LL << 7)) {
+                write_byte(0xd1);
+                write_be16((uint16_t) value);
+            } else {
+                write_byte(0xd0);
+                write_byte((uint8_t) value);
+            }
+        } else if (value < (1LL << 7)) {
+            /* positive and negative fixint */
+            write_byte((uint8_t) value);
+        } else if (value < (1LL << 16)) {
+            if (value < (1LL << 8)) {
+                write_byte(0xcc);
+                write_byte((uint8_t) value);
+            } else {
+                write_byte(0xcd);
+                write_be16((uint16_t) value);
+            }
+        } else if (value < (1LL << 32)) {
+            write_byte(0xce);
+            write_be32((uint32_t) value);
+        } else {
+            write_byte(0xcf);
+            write_be64((uint64_t) value);
+        }
+    }
+
+    void MsgpackPacker::pack_double(double value)
+    {
+        uint64_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+        write_byte(0xcb);
+        write_be64(bits);
+    }
+
+    void MsgpackPacker::pack_bool(bool value)
+    {
+        write_byte(value ? 0xc3 : 0xc2);
+    }
+
+    void MsgpackPacker::pack_list_header(uint32_t count)
+    {
+        if (count < 16) {
+            write_byte(0x90 | (uint8_t) count);
+        } else if (count < 65536) {
+            write_byte(0xdc);
+            write_be16((uint16_t) count);
+        } else {
+            write_byte(0xdd);
+            write_be32(count);
+        }
+    }
+
+    void MsgpackPacker::pack_map_header(uint32_t count)
+    {
+        if (count < 16) {
+            write_byte(0x80 | (uint8_t) count);
+        } else if (count < 65536) {
+            write_byte(0xde);
+            write_be16((uint16_t) count);
+        } else {
+            write_byte(0xdf);
+            write_be32(count);
+        }
+    }
+
+    /*
+     *******************************************************************************************
+     * Packs a string as a raw value prefixed with the AS_BYTES_STRING type byte.
+     *******************************************************************************************
+     */
+    void MsgpackPacker::pack_string(const char *str_p, uint32_t length)
+    {
+        pack_blob(AS_BYTES_STRING, str_p, length);
+    }
+
+    /*
+     *******************************************************************************************
+     * Packs a blob as a raw value prefixed with its as_bytes_type byte.
+     *******************************************************************************************
+     */
+    void MsgpackPacker::pack_blob(as_bytes_type bytes_type, const char *blob_p, uint32_t length)
+    {
+        pack_raw_header(length + 1);
+        write_byte((uint8_t) bytes_type);
+        write_bytes(blob_p, length);
+    }
+
+    /*
+     *******************************************************************************************
+     * Transfers the ownership of the packed buffer to the given as_bytes.
+     * The buffer is freed by as_bytes_destroy(), i.e. when the record or the
+     * operations holding the as_bytes are destroyed.
+     *
+     * @param bytes_p           The as_bytes to be initialized with the buffer.
+     * @param bytes_type        AS_BYTES_LIST or AS_BYTES_MAP.
+     * @param error             as_error reference to be populated by this function
+     *                          in case of error
+     *
+     * @return AEROSPIKE_OK if success. Otherwise AEROSPIKE_ERR_*.
+     *******************************************************************************************
+     */
+    as_status MsgpackPacker::release_to_as_bytes(as_bytes *bytes_p, as_bytes_type bytes_type, as_error& error)
+    {
+        as_error_reset(&error);
+
+        if (!bytes_p) {
+            return as_error_update(&error, AEROSPIKE_ERR_CLIENT,
+                    "Unable to set packed value: as_bytes is null");
+        }
+
+        if (failed || !buffer_p) {
+            reset();
+            return as_error_update(&error, AEROSPIKE_ERR_CLIENT,
+                    "Unable to pack value: memory allocation failed");
+        }
+
+        as_bytes_init_wrap(bytes_p, buffer_p, size, true);
+        as_bytes_set_type(bytes_p, bytes_type);
+
+        buffer_p = NULL;
+        size = 0;
+        capacity = 0;
+        return error.code;
+    }
+} // namespace HPHP
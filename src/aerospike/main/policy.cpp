@@ -55,25 +55,36 @@ namespace HPHP {
     {
         if (strcmp("read", this->type) == 0) {
             POLICY_INIT(read);
+            this->type_id = POLICY_TYPE_READ;
         } else if (strcmp("write", this->type) == 0) {
             POLICY_INIT(write);
+            this->type_id = POLICY_TYPE_WRITE;
         } else if (strcmp("operate", this->type) == 0) {
             POLICY_INIT(operate);
+            this->type_id = POLICY_TYPE_OPERATE;
         } else if (strcmp("remove", this->type) == 0) {
             POLICY_INIT(remove);
+            this->type_id = POLICY_TYPE_REMOVE;
         } else if (strcmp("info", this->type) == 0) {
             POLICY_INIT(info);
+            this->type_id = POLICY_TYPE_INFO;
         } else if (strcmp("scan", this->type) == 0) {
             POLICY_INIT(scan);
+            this->type_id = POLICY_TYPE_SCAN;
         } else if (strcmp("query", this->type) == 0) {
             POLICY_INIT(query);
+            this->type_id = POLICY_TYPE_QUERY;
         } else if (strcmp("apply", this->type) == 0) {
             POLICY_INIT(apply);
+            this->type_id = POLICY_TYPE_APPLY;
         } else if (strcmp("admin", this->type) == 0) {
             POLICY_INIT(admin);
+            this->type_id = POLICY_TYPE_ADMIN;
         } else if (strcmp("batch", this->type) == 0) {
             POLICY_INIT(batch);
+            this->type_id = POLICY_TYPE_BATCH;
         } else {
+            this->type_id = POLICY_TYPE_NONE;
             return false;
         }
 
@@ -152,6 +163,14 @@ namespace HPHP {
                     "gen is null");
         }
 
+        if (options_variant.isObject()) {
+            AerospikePolicy *compiled_p = AerospikePolicy::fromVariant(options_variant);
+            if (compiled_p && compiled_p->has_gen_value) {
+                *gen_value_p = compiled_p->gen_value;
+            }
+            return error.code;
+        }
+
         Array  options = options_variant.toArray();
         if (options.exists(OPT_POLICY_GEN) && options[OPT_POLICY_GEN].isArray()) {
             Array gen_policy = options[OPT_POLICY_GEN].toArray();
@@ -189,6 +208,14 @@ namespace HPHP {
                     "TTL is null");
         }
 
+        if (options_variant.isObject()) {
+            AerospikePolicy *compiled_p = AerospikePolicy::fromVariant(options_variant);
+            if (compiled_p && compiled_p->has_ttl_value) {
+                *ttl_value_p = compiled_p->ttl_value;
+            }
+            return error.code;
+        }
+
         Array options = options_variant.toArray();
         if (options.exists(OPT_TTL)) {
             if (options[OPT_TTL].isInteger()) {
@@ -201,6 +228,355 @@ namespace HPHP {
 
         return error.code;
     }
+
+    /*
+     *******************************************************************************************
+     * Function for setting whether the results of a batch read are returned as
+     * a list in the order of the keys rather than keyed by the record keys.
+     *
+     * @param positional_p      The flag to be set
+     * @param options_variant   The user's optional policy options to be used if
+     *                          set
+     * @param error             as_error reference to be populated by this function
+     *                          in case of error
+     *
+     * @return AEROSPIKE_OK if success. Otherwise AEROSPIKE_ERR_*.
+     *******************************************************************************************
+     */
+    as_status PolicyManager::set_batch_positional(bool *positional_p, const Variant& options_variant, as_error& error)
+    {
+        as_error_reset(&error);
+
+        if (!positional_p) {
+            return as_error_update(&error, AEROSPIKE_ERR_CLIENT,
+                    "Batch positional flag is null");
+        }
+
+        if (options_variant.isObject()) {
+            AerospikePolicy *compiled_p = AerospikePolicy::fromVariant(options_variant);
+            if (compiled_p && compiled_p->has_batch_positional) {
+                *positional_p = compiled_p->batch_positional;
+            }
+            return error.code;
+        }
+
+        Array options = options_variant.toArray();
+        if (options.exists(OPT_BATCH_POSITIONAL)) {
+            if (options[OPT_BATCH_POSITIONAL].isBoolean()) {
+                *positional_p = options[OPT_BATCH_POSITIONAL].toBoolean();
+            } else {
+                return as_error_update(&error, AEROSPIKE_ERR_PARAM,
+                        "Batch positional value should be of boolean type");
+            }
+        }
+
+        return error.code;
+    }
+
+    /*
+     *******************************************************************************************
+     * Function for setting how a batch read is split into sub-batches, read
+     * concurrently and read again on timeout, and how many times the keys
+     * which failed are read again.
+     *
+     * @param chunking_p        The batch_chunking to be set
+     * @param options_variant   The user's optional policy options to be used if
+     *                          set
+     * @param error             as_error reference to be populated by this function
+     *                          in case of error
+     *
+     * @return AEROSPIKE_OK if success. Otherwise AEROSPIKE_ERR_*.
+     *******************************************************************************************
+     */
+    as_status PolicyManager::set_batch_chunking(batch_chunking *chunking_p, const Variant& options_variant, as_error& error)
+    {
+        as_error_reset(&error);
+
+        if (!chunking_p) {
+            return as_error_update(&error, AEROSPIKE_ERR_CLIENT,
+                    "Batch chunking is null");
+        }
+
+        if (options_variant.isObject()) {
+            AerospikePolicy *compiled_p = AerospikePolicy::fromVariant(options_variant);
+            if (compiled_p && compiled_p->has_batch_chunking) {
+                *chunking_p = compiled_p->chunking;
+            }
+            return error.code;
+        }
+
+        Array options = options_variant.toArray();
+        if (options.exists(OPT_BATCH_CHUNK_SIZE)) {
+            if (!options[OPT_BATCH_CHUNK_SIZE].isInteger() ||
+                    options[OPT_BATCH_CHUNK_SIZE].toInt64() < 0) {
+                return as_error_update(&error, AEROSPIKE_ERR_PARAM,
+                        "Batch chunk size should be a non-negative integer");
+            }
+            chunking_p->chunk_size = options[OPT_BATCH_CHUNK_SIZE].toInt32();
+        }
+        if (options.exists(OPT_BATCH_MAX_IN_FLIGHT)) {
+            if (!options[OPT_BATCH_MAX_IN_FLIGHT].isInteger() ||
+                    options[OPT_BATCH_MAX_IN_FLIGHT].toInt64() < 1) {
+                return as_error_update(&error, AEROSPIKE_ERR_PARAM,
+                        "Batch max in flight should be a positive integer");
+            }
+            chunking_p->max_in_flight = options[OPT_BATCH_MAX_IN_FLIGHT].toInt32();
+        }
+        if (options.exists(OPT_BATCH_CHUNK_RETRIES)) {
+            if (!options[OPT_BATCH_CHUNK_RETRIES].isInteger() ||
+                    options[OPT_BATCH_CHUNK_RETRIES].toInt64() < 0) {
+                return as_error_update(&error, AEROSPIKE_ERR_PARAM,
+                        "Batch chunk retries should be a non-negative integer");
+            }
+            chunking_p->retries = options[OPT_BATCH_CHUNK_RETRIES].toInt32();
+        }
+        if (options.exists(OPT_BATCH_RETRY_FAILED_KEYS)) {
+            if (!options[OPT_BATCH_RETRY_FAILED_KEYS].isInteger() ||
+                    options[OPT_BATCH_RETRY_FAILED_KEYS].toInt64() < 0) {
+                return as_error_update(&error, AEROSPIKE_ERR_PARAM,
+                        "Batch failed key retries should be a non-negative integer");
+            }
+            chunking_p->failed_key_retries = options[OPT_BATCH_RETRY_FAILED_KEYS].toInt32();
+        }
+
+        return error.code;
+    }
+
+    /*
+     *******************************************************************************************
+     * Function for setting how the result of a batch exists is returned: as
+     * the metadata of each key, as a string holding a bit per key or as a
+     * list holding a boolean per key.
+     *
+     * @param format_p          The Aerospike::BATCH_EXISTS_* value to be set
+     * @param options_variant   The user's optional policy options to be used if
+     *                          set
+     * @param error             as_error reference to be populated by this function
+     *                          in case of error
+     *
+     * @return AEROSPIKE_OK if success. Otherwise AEROSPIKE_ERR_*.
+     *******************************************************************************************
+     */
+    as_status PolicyManager::set_batch_exists_format(int16_t *format_p, const Variant& options_variant, as_error& error)
+    {
+        as_error_reset(&error);
+
+        if (!format_p) {
+            return as_error_update(&error, AEROSPIKE_ERR_CLIENT,
+                    "Batch exists format is null");
+        }
+
+        if (options_variant.isObject()) {
+            AerospikePolicy *compiled_p = AerospikePolicy::fromVariant(options_variant);
+            if (compiled_p && compiled_p->has_batch_exists_format) {
+                *format_p = compiled_p->batch_exists_format;
+            }
+            return error.code;
+        }
+
+        Array options = options_variant.toArray();
+        if (options.exists(OPT_BATCH_EXISTS_FORMAT)) {
+            int64_t format = options[OPT_BATCH_EXISTS_FORMAT].toInt64();
+            if (!options[OPT_BATCH_EXISTS_FORMAT].isInteger() ||
+                    (format != BATCH_EXISTS_METADATA && format != BATCH_EXISTS_BITMAP &&
+                     format != BATCH_EXISTS_BOOLS)) {
+                return as_error_update(&error, AEROSPIKE_ERR_PARAM,
+                        "Batch exists format should be one of Aerospike::BATCH_EXISTS_*");
+            }
+            *format_p = format;
+        }
+
+        return error.code;
+    }
+
+    /*
+     *******************************************************************************************
+     * Function for setting the no. of records a scan iterator, a query or a
+     * concurrent scan buffers ahead of the records being iterated or passed
+     * to the callback.
+     *
+     * @param buffer_size_p     The buffer size to be set
+     * @param options_variant   The user's optional policy options to be used if
+     *                          set
+     * @param error             as_error reference to be populated by this function
+     *                          in case of error
+     *
+     * @return AEROSPIKE_OK if success. Otherwise AEROSPIKE_ERR_*.
+     *******************************************************************************************
+     */
+    as_status PolicyManager::set_scan_buffer_size(uint32_t *buffer_size_p, const Variant& options_variant, as_error& error)
+    {
+        as_error_reset(&error);
+
+        if (!buffer_size_p) {
+            return as_error_update(&error, AEROSPIKE_ERR_CLIENT,
+                    "Scan buffer size is null");
+        }
+
+        if (options_variant.isObject()) {
+            AerospikePolicy *compiled_p = AerospikePolicy::fromVariant(options_variant);
+            if (compiled_p && compiled_p->has_scan_buffer_size) {
+                *buffer_size_p = compiled_p->scan_buffer_size;
+            }
+            return error.code;
+        }
+
+        Array options = options_variant.toArray();
+        if (options.exists(OPT_SCAN_BUFFER_SIZE)) {
+            if (!options[OPT_SCAN_BUFFER_SIZE].isInteger() ||
+                    options[OPT_SCAN_BUFFER_SIZE].toInt64() < 1 ||
+                    options[OPT_SCAN_BUFFER_SIZE].toInt64() > UINT32_MAX) {
+                return as_error_update(&error, AEROSPIKE_ERR_PARAM,
+                        "Scan buffer size should be a positive integer");
+            }
+            *buffer_size_p = (uint32_t) options[OPT_SCAN_BUFFER_SIZE].toInt64();
+        }
+
+        return error.code;
+    }
+
+    /*
+     *******************************************************************************************
+     * Function for setting the no. of records passed to each call of the
+     * callback of a scan or a query, as a list. 0 passes each record on its
+     * own, not in a list.
+     *
+     * @param chunk_size_p      The chunk size to be set
+     * @param options_variant   The user's optional policy options to be used if
+     *                          set
+     * @param error             as_error reference to be populated by this function
+     *                          in case of error
+     *
+     * @return AEROSPIKE_OK if success. Otherwise AEROSPIKE_ERR_*.
+     *******************************************************************************************
+     */
+    as_status PolicyManager::set_callback_chunk_size(uint32_t *chunk_size_p, const Variant& options_variant, as_error& error)
+    {
+        as_error_reset(&error);
+
+        if (!chunk_size_p) {
+            return as_error_update(&error, AEROSPIKE_ERR_CLIENT,
+                    "Callback chunk size is null");
+        }
+
+        if (options_variant.isObject()) {
+            AerospikePolicy *compiled_p = AerospikePolicy::fromVariant(options_variant);
+            if (compiled_p && compiled_p->has_callback_chunk_size) {
+                *chunk_size_p = compiled_p->callback_chunk_size;
+            }
+            return error.code;
+        }
+
+        Array options = options_variant.toArray();
+        if (options.exists(OPT_CALLBACK_CHUNK_SIZE)) {
+            if (!options[OPT_CALLBACK_CHUNK_SIZE].isInteger() ||
+                    options[OPT_CALLBACK_CHUNK_SIZE].toInt64() < 0 ||
+                    options[OPT_CALLBACK_CHUNK_SIZE].toInt64() > CALLBACK_CHUNK_SIZE_MAX) {
+                return as_error_update(&error, AEROSPIKE_ERR_PARAM,
+                        "Callback chunk size should be an integer within 0-65536");
+            }
+            *chunk_size_p = (uint32_t) options[OPT_CALLBACK_CHUNK_SIZE].toInt64();
+        }
+
+        return error.code;
+    }
+
+    /*
+     *******************************************************************************************
+     * Function for setting the range of partitions a scan is restricted to,
+     * given as an array of the first and the last partition, within 0-4095.
+     *
+     * @param range_p           The partition range to be set
+     * @param options_variant   The user's optional policy options to be used if
+     *                          set
+     * @param error             as_error reference to be populated by this function
+     *                          in case of error
+     *
+     * @return AEROSPIKE_OK if success. Otherwise AEROSPIKE_ERR_*.
+     *******************************************************************************************
+     */
+    as_status PolicyManager::set_scan_partitions(scan_partition_range *range_p, const Variant& options_variant, as_error& error)
+    {
+        as_error_reset(&error);
+
+        if (!range_p) {
+            return as_error_update(&error, AEROSPIKE_ERR_CLIENT,
+                    "Scan partition range is null");
+        }
+
+        if (options_variant.isObject()) {
+            AerospikePolicy *compiled_p = AerospikePolicy::fromVariant(options_variant);
+            if (compiled_p && compiled_p->scan_partitions.is_set) {
+                *range_p = compiled_p->scan_partitions;
+            }
+            return error.code;
+        }
+
+        Array options = options_variant.toArray();
+        if (options.exists(OPT_SCAN_PARTITIONS)) {
+            Array range = Array::Create();
+            if (options[OPT_SCAN_PARTITIONS].isArray()) {
+                range = options[OPT_SCAN_PARTITIONS].toArray();
+            }
+            if (range.size() != 2 || !range.exists(0) || !range.exists(1) ||
+                    !range[0].isInteger() || !range[1].isInteger() ||
+                    range[0].toInt64() < 0 || range[0].toInt64() > range[1].toInt64() ||
+                    range[1].toInt64() >= SCAN_PARTITIONS_COUNT) {
+                return as_error_update(&error, AEROSPIKE_ERR_PARAM,
+                        "Scan partitions should be an array of the first and the last partition, within 0-4095");
+            }
+            range_p->is_set = true;
+            range_p->begin = (uint16_t) range[0].toInt64();
+            range_p->end = (uint16_t) range[1].toInt64();
+        }
+
+        return error.code;
+    }
+
+    /*
+     *******************************************************************************************
+     * Function for setting the max no. of records returned by a scan or a
+     * query, 0 for no limit.
+     *
+     * @param max_records_p     The max no. of records to be set
+     * @param options_variant   The user's optional policy options to be used if
+     *                          set
+     * @param error             as_error reference to be populated by this function
+     *                          in case of error
+     *
+     * @return AEROSPIKE_OK if success. Otherwise AEROSPIKE_ERR_*.
+     *******************************************************************************************
+     */
+    as_status PolicyManager::set_max_records(uint64_t *max_records_p, const Variant& options_variant, as_error& error)
+    {
+        as_error_reset(&error);
+
+        if (!max_records_p) {
+            return as_error_update(&error, AEROSPIKE_ERR_CLIENT,
+                    "Max records is null");
+        }
+
+        if (options_variant.isObject()) {
+            AerospikePolicy *compiled_p = AerospikePolicy::fromVariant(options_variant);
+            if (compiled_p && compiled_p->has_max_records) {
+                *max_records_p = compiled_p->max_records;
+            }
+            return error.code;
+        }
+
+        Array options = options_variant.toArray();
+        if (options.exists(OPT_MAX_RECORDS)) {
+            if (!options[OPT_MAX_RECORDS].isInteger() ||
+                    options[OPT_MAX_RECORDS].toInt64() < 0) {
+                return as_error_update(&error, AEROSPIKE_ERR_PARAM,
+                        "Max records should be a non-negative integer");
+            }
+            *max_records_p = (uint64_t) options[OPT_MAX_RECORDS].toInt64();
+        }
+
+        return error.code;
+    }
+
     /*
      *******************************************************************************************
      * Wrapper function for setting the relevant aerospike policies by using the user's
@@ -227,202 +603,234 @@ namespace HPHP {
                     "config/type/policy holder is null");
         }
 
+        if (options_variant.isObject()) {
+            AerospikePolicy *compiled_p = AerospikePolicy::fromVariant(options_variant);
+            if (!compiled_p || !compiled_p->is_compiled) {
+                return as_error_update(&error, AEROSPIKE_ERR_PARAM,
+                        "Policy options must be of type an Array or a valid AerospikePolicy");
+            }
+            return set_compiled_policy(compiled_p, serializer_value, global_serializer_val, error);
+        }
+
         if (!options_variant.isNull() && !options_variant.isArray()) {
             return as_error_update(&error, AEROSPIKE_ERR_PARAM,
                     "Policy options must be of type an Array");
         }
         
-        if (strcmp(this->type, "read") == 0) {
-            as_policy_read_copy(&(this->config_p->policies.read), CURRENT_POLICY(read));
+        switch (this->type_id) {
+            case POLICY_TYPE_READ:
+                as_policy_read_copy(&(this->config_p->policies.read), CURRENT_POLICY(read));
 
-            if (options_variant.isArray()) {
-                Array  options = options_variant.toArray();
-                if (options.exists(OPT_READ_TIMEOUT) && options[OPT_READ_TIMEOUT].isInteger()) {
-                    POLICY_SET_FIELD(read, timeout, options[OPT_READ_TIMEOUT].toInt32(), uint32_t);
-                }
-                if (options.exists(OPT_POLICY_KEY) && options[OPT_POLICY_KEY].isInteger()) {
-                    POLICY_SET_FIELD(read, key, options[OPT_POLICY_KEY].toInt32(), as_policy_key);
-                }
-                if (options.exists(OPT_POLICY_REPLICA) && options[OPT_POLICY_REPLICA].isInteger()) {
-                    POLICY_SET_FIELD(read, replica, options[OPT_POLICY_REPLICA].toInt32(), as_policy_replica);
-                }
-                if (options.exists(OPT_POLICY_CONSISTENCY) && options[OPT_POLICY_CONSISTENCY].isInteger()) {
-                    POLICY_SET_FIELD(read, consistency_level, options[OPT_POLICY_CONSISTENCY].toInt32(), as_policy_consistency_level);
+                if (options_variant.isArray()) {
+                    Array  options = options_variant.toArray();
+                    if (options.exists(OPT_READ_TIMEOUT) && options[OPT_READ_TIMEOUT].isInteger()) {
+                        POLICY_SET_FIELD(read, timeout, options[OPT_READ_TIMEOUT].toInt32(), uint32_t);
+                    }
+                    if (options.exists(OPT_POLICY_KEY) && options[OPT_POLICY_KEY].isInteger()) {
+                        POLICY_SET_FIELD(read, key, options[OPT_POLICY_KEY].toInt32(), as_policy_key);
+                    }
+                    if (options.exists(OPT_POLICY_REPLICA) && options[OPT_POLICY_REPLICA].isInteger()) {
+                        POLICY_SET_FIELD(read, replica, options[OPT_POLICY_REPLICA].toInt32(), as_policy_replica);
+                    }
+                    if (options.exists(OPT_POLICY_CONSISTENCY) && options[OPT_POLICY_CONSISTENCY].isInteger()) {
+                        POLICY_SET_FIELD(read, consistency_level, options[OPT_POLICY_CONSISTENCY].toInt32(), as_policy_consistency_level);
+                    }
                 }
-            }
-        } else if (strcmp(this->type, "write") == 0) {
-            as_policy_write_copy(&(this->config_p->policies.write), CURRENT_POLICY(write));
+                break;
+            case POLICY_TYPE_WRITE:
+                as_policy_write_copy(&(this->config_p->policies.write), CURRENT_POLICY(write));
 
-            if (options_variant.isArray()) {
-                Array  options = options_variant.toArray();
-                if (options.exists(OPT_WRITE_TIMEOUT) && options[OPT_WRITE_TIMEOUT].isInteger()) {
-                    POLICY_SET_FIELD(write, timeout, options[OPT_WRITE_TIMEOUT].toInt32(), uint32_t);
-                }
-                if (options.exists(OPT_POLICY_KEY) && options[OPT_POLICY_KEY].isInteger()) {
-                    POLICY_SET_FIELD(write, key, options[OPT_POLICY_KEY].toInt32(), as_policy_key);
-                }
-                if (options.exists(OPT_POLICY_RETRY) && options[OPT_POLICY_RETRY].isInteger()) {
-                    POLICY_SET_FIELD(write, retry, options[OPT_POLICY_RETRY].toInt32(), as_policy_retry);
-                }
-                if (options.exists(OPT_POLICY_GEN) && options[OPT_POLICY_GEN].isArray()) {
-                    Array gen_policy = options[OPT_POLICY_GEN].toArray();
-                    POLICY_SET_FIELD(write, gen, gen_policy[0].toInt32(), as_policy_gen);
-                }
-                if (options.exists(OPT_POLICY_EXISTS) && options[OPT_POLICY_EXISTS].isInteger()) {
-                    POLICY_SET_FIELD(write, exists, options[OPT_POLICY_EXISTS].toInt32(), as_policy_exists);
-                }
-                if (options.exists(OPT_POLICY_COMMIT_LEVEL) && options[OPT_POLICY_COMMIT_LEVEL].isInteger()) {
-                    POLICY_SET_FIELD(write, commit_level, options[OPT_POLICY_COMMIT_LEVEL].toInt32(), as_policy_commit_level);
-                }
-                if (serializer_value) {
-                    *serializer_value = global_serializer_val;
-                    if (options.exists(OPT_SERIALIZER) && options[OPT_SERIALIZER].isInteger()) {
-                        *serializer_value = options[OPT_SERIALIZER].toInt16();
+                if (options_variant.isArray()) {
+                    Array  options = options_variant.toArray();
+                    if (options.exists(OPT_WRITE_TIMEOUT) && options[OPT_WRITE_TIMEOUT].isInteger()) {
+                        POLICY_SET_FIELD(write, timeout, options[OPT_WRITE_TIMEOUT].toInt32(), uint32_t);
+                    }
+                    if (options.exists(OPT_POLICY_KEY) && options[OPT_POLICY_KEY].isInteger()) {
+                        POLICY_SET_FIELD(write, key, options[OPT_POLICY_KEY].toInt32(), as_policy_key);
+                    }
+                    if (options.exists(OPT_POLICY_RETRY) && options[OPT_POLICY_RETRY].isInteger()) {
+                        POLICY_SET_FIELD(write, retry, options[OPT_POLICY_RETRY].toInt32(), as_policy_retry);
+                    }
+                    if (options.exists(OPT_POLICY_GEN) && options[OPT_POLICY_GEN].isArray()) {
+                        Array gen_policy = options[OPT_POLICY_GEN].toArray();
+                        POLICY_SET_FIELD(write, gen, gen_policy[0].toInt32(), as_policy_gen);
+                    }
+                    if (options.exists(OPT_POLICY_EXISTS) && options[OPT_POLICY_EXISTS].isInteger()) {
+                        POLICY_SET_FIELD(write, exists, options[OPT_POLICY_EXISTS].toInt32(), as_policy_exists);
+                    }
+                    if (options.exists(OPT_POLICY_COMMIT_LEVEL) && options[OPT_POLICY_COMMIT_LEVEL].isInteger()) {
+                        POLICY_SET_FIELD(write, commit_level, options[OPT_POLICY_COMMIT_LEVEL].toInt32(), as_policy_commit_level);
+                    }
+                    if (serializer_value) {
+                        *serializer_value = global_serializer_val;
+                        if (options.exists(OPT_SERIALIZER) && options[OPT_SERIALIZER].isInteger()) {
+                            *serializer_value = options[OPT_SERIALIZER].toInt16();
+                        }
+                    }
+                } else {
+                    if (serializer_value) {
+                        *serializer_value = global_serializer_val;
                     }
                 }
-            } else {
-                if (serializer_value) {
-                    *serializer_value = global_serializer_val;
-                }
-            }
-        } else if (strcmp(this->type, "operate") == 0) {
-            as_policy_operate_copy(&(this->config_p->policies.operate), CURRENT_POLICY(operate));
+                break;
+            case POLICY_TYPE_OPERATE:
+                as_policy_operate_copy(&(this->config_p->policies.operate), CURRENT_POLICY(operate));
 
-            if (options_variant.isArray()) {
-                Array  options = options_variant.toArray();
-                if (options.exists(OPT_WRITE_TIMEOUT) && options[OPT_WRITE_TIMEOUT].isInteger()) {
-                    POLICY_SET_FIELD(operate, timeout, options[OPT_WRITE_TIMEOUT].toInt32(), uint32_t);
-                }
-                if (options.exists(OPT_POLICY_KEY) && options[OPT_POLICY_KEY].isInteger()) {
-                    POLICY_SET_FIELD(operate, key, options[OPT_POLICY_KEY].toInt32(), as_policy_key);
-                }
-                if (options.exists(OPT_POLICY_RETRY) && options[OPT_POLICY_RETRY].isInteger()) {
-                    POLICY_SET_FIELD(operate, retry, options[OPT_POLICY_RETRY].toInt32(), as_policy_retry);
-                }
-                if (options.exists(OPT_POLICY_GEN) && options[OPT_POLICY_GEN].isArray()) {
-                    Array gen_policy = options[OPT_POLICY_GEN].toArray();
-                    POLICY_SET_FIELD(operate, gen, gen_policy[0].toInt32(), as_policy_gen);
-                }
-                if (options.exists(OPT_POLICY_REPLICA) && options[OPT_POLICY_REPLICA].isInteger()) {
-                    POLICY_SET_FIELD(operate, replica, options[OPT_POLICY_REPLICA].toInt32(), as_policy_replica);
-                }
-                if (options.exists(OPT_POLICY_CONSISTENCY) && options[OPT_POLICY_CONSISTENCY].isInteger()) {
-                    POLICY_SET_FIELD(operate, consistency_level, options[OPT_POLICY_CONSISTENCY].toInt32(), as_policy_consistency_level);
-                }
-                if (options.exists(OPT_POLICY_COMMIT_LEVEL) && options[OPT_POLICY_COMMIT_LEVEL].isInteger()) {
-                    POLICY_SET_FIELD(operate, commit_level, options[OPT_POLICY_COMMIT_LEVEL].toInt32(), as_policy_commit_level);
-                }
-                if (serializer_value) {
-                    *serializer_value = global_serializer_val;
-                    if (options.exists(OPT_SERIALIZER) && options[OPT_SERIALIZER].isInteger()) {
-                        *serializer_value = options[OPT_SERIALIZER].toInt16();
+                if (options_variant.isArray()) {
+                    Array  options = options_variant.toArray();
+                    if (options.exists(OPT_WRITE_TIMEOUT) && options[OPT_WRITE_TIMEOUT].isInteger()) {
+                        POLICY_SET_FIELD(operate, timeout, options[OPT_WRITE_TIMEOUT].toInt32(), uint32_t);
+                    }
+                    if (options.exists(OPT_POLICY_KEY) && options[OPT_POLICY_KEY].isInteger()) {
+                        POLICY_SET_FIELD(operate, key, options[OPT_POLICY_KEY].toInt32(), as_policy_key);
+                    }
+                    if (options.exists(OPT_POLICY_RETRY) && options[OPT_POLICY_RETRY].isInteger()) {
+                        POLICY_SET_FIELD(operate, retry, options[OPT_POLICY_RETRY].toInt32(), as_policy_retry);
+                    }
+                    if (options.exists(OPT_POLICY_GEN) && options[OPT_POLICY_GEN].isArray()) {
+                        Array gen_policy = options[OPT_POLICY_GEN].toArray();
+                        POLICY_SET_FIELD(operate, gen, gen_policy[0].toInt32(), as_policy_gen);
+                    }
+                    if (options.exists(OPT_POLICY_REPLICA) && options[OPT_POLICY_REPLICA].isInteger()) {
+                        POLICY_SET_FIELD(operate, replica, options[OPT_POLICY_REPLICA].toInt32(), as_policy_replica);
+                    }
+                    if (options.exists(OPT_POLICY_CONSISTENCY) && options[OPT_POLICY_CONSISTENCY].isInteger()) {
+                        POLICY_SET_FIELD(operate, consistency_level, options[OPT_POLICY_CONSISTENCY].toInt32(), as_policy_consistency_level);
+                    }
+                    if (options.exists(OPT_POLICY_COMMIT_LEVEL) && options[OPT_POLICY_COMMIT_LEVEL].isInteger()) {
+                        POLICY_SET_FIELD(operate, commit_level, options[OPT_POLICY_COMMIT_LEVEL].toInt32(), as_policy_commit_level);
+                    }
+                    if (serializer_value) {
+                        *serializer_value = global_serializer_val;
+                        if (options.exists(OPT_SERIALIZER) && options[OPT_SERIALIZER].isInteger()) {
+                            *serializer_value = options[OPT_SERIALIZER].toInt16();
+                        }
+                    }
+                } else {
+                    if (serializer_value) {
+                        *serializer_value = global_serializer_val;
                     }
                 }
-            } else {
-                if (serializer_value) {
-                    *serializer_value = global_serializer_val;
-                }
-            }
-        } else if (strcmp(this->type, "remove") == 0) {
-            as_policy_remove_copy(&(this->config_p->policies.remove), CURRENT_POLICY(remove));
+                break;
+            case POLICY_TYPE_REMOVE:
+                as_policy_remove_copy(&(this->config_p->policies.remove), CURRENT_POLICY(remove));
 
-            if (options_variant.isArray()) {
-                Array  options = options_variant.toArray();
-                if (options.exists(OPT_WRITE_TIMEOUT) && options[OPT_WRITE_TIMEOUT].isInteger()) {
-                    POLICY_SET_FIELD(remove, timeout, options[OPT_WRITE_TIMEOUT].toInt32(), uint32_t);
-                }
-                if (options.exists(OPT_POLICY_KEY) && options[OPT_POLICY_KEY].isInteger()) {
-                    POLICY_SET_FIELD(remove, key, options[OPT_POLICY_KEY].toInt32(), as_policy_key);
-                }
-                if (options.exists(OPT_POLICY_RETRY) && options[OPT_POLICY_RETRY].isInteger()) {
-                    POLICY_SET_FIELD(remove, retry, options[OPT_POLICY_RETRY].toInt32(), as_policy_retry);
-                }
-                if (options.exists(OPT_POLICY_GEN) && options[OPT_POLICY_GEN].isArray()) {
-                    Array gen_policy = options[OPT_POLICY_GEN].toArray();
-                    POLICY_SET_FIELD(remove, gen, gen_policy[0].toInt32(), as_policy_gen);
-                }
-                if (options.exists(OPT_POLICY_COMMIT_LEVEL) && options[OPT_POLICY_COMMIT_LEVEL].isInteger()) {
-                    POLICY_SET_FIELD(remove, commit_level, options[OPT_POLICY_COMMIT_LEVEL].toInt32(), as_policy_commit_level);
+                if (options_variant.isArray()) {
+                    Array  options = options_variant.toArray();
+                    if (options.exists(OPT_WRITE_TIMEOUT) && options[OPT_WRITE_TIMEOUT].isInteger()) {
+                        POLICY_SET_FIELD(remove, timeout, options[OPT_WRITE_TIMEOUT].toInt32(), uint32_t);
+                    }
+                    if (options.exists(OPT_POLICY_KEY) && options[OPT_POLICY_KEY].isInteger()) {
+                        POLICY_SET_FIELD(remove, key, options[OPT_POLICY_KEY].toInt32(), as_policy_key);
+                    }
+                    if (options.exists(OPT_POLICY_RETRY) && options[OPT_POLICY_RETRY].isInteger()) {
+                        POLICY_SET_FIELD(remove, retry, options[OPT_POLICY_RETRY].toInt32(), as_policy_retry);
+                    }
+                    if (options.exists(OPT_POLICY_GEN) && options[OPT_POLICY_GEN].isArray()) {
+                        Array gen_policy = options[OPT_POLICY_GEN].toArray();
+                        POLICY_SET_FIELD(remove, gen, gen_policy[0].toInt32(), as_policy_gen);
+                    }
+                    if (options.exists(OPT_POLICY_COMMIT_LEVEL) && options[OPT_POLICY_COMMIT_LEVEL].isInteger()) {
+                        POLICY_SET_FIELD(remove, commit_level, options[OPT_POLICY_COMMIT_LEVEL].toInt32(), as_policy_commit_level);
+                    }
                 }
-            }
-        } else if (strcmp(this->type, "batch") == 0) {
-            as_policy_batch_copy(&(this->config_p->policies.batch), CURRENT_POLICY(batch));
+                break;
+            case POLICY_TYPE_BATCH:
+                as_policy_batch_copy(&(this->config_p->policies.batch), CURRENT_POLICY(batch));
 
-            if (options_variant.isArray()) {
-                Array  options = options_variant.toArray();
-                if (options.exists(OPT_READ_TIMEOUT) && options[OPT_READ_TIMEOUT].isInteger()) {
-                    POLICY_SET_FIELD(batch, timeout, options[OPT_READ_TIMEOUT].toInt32(), uint32_t);
+                if (options_variant.isArray()) {
+                    Array  options = options_variant.toArray();
+                    if (options.exists(OPT_READ_TIMEOUT) && options[OPT_READ_TIMEOUT].isInteger()) {
+                        POLICY_SET_FIELD(batch, timeout, options[OPT_READ_TIMEOUT].toInt32(), uint32_t);
+                    }
                 }
-            }
-        } else if (strcmp(this->type, "scan") == 0) {
-            as_policy_scan_copy(&(this->config_p->policies.scan), CURRENT_POLICY(scan));
+                break;
+            case POLICY_TYPE_SCAN:
+                as_policy_scan_copy(&(this->config_p->policies.scan), CURRENT_POLICY(scan));
 
-            if (options_variant.isArray()) {
-                Array  options = options_variant.toArray();
-                if (options.exists(OPT_READ_TIMEOUT)) {
-                    if (options[OPT_READ_TIMEOUT].isInteger()) {
-                        POLICY_SET_FIELD(scan, timeout, options[OPT_READ_TIMEOUT].toInt64(), uint32_t);
-                    } else {
-                        as_error_update(&error, AEROSPIKE_ERR_PARAM, "Unable to set policy: Invalid Value for OPT_READ_TIMEOUT");
+                if (options_variant.isArray()) {
+                    Array  options = options_variant.toArray();
+                    if (options.exists(OPT_READ_TIMEOUT)) {
+                        if (options[OPT_READ_TIMEOUT].isInteger()) {
+                            POLICY_SET_FIELD(scan, timeout, options[OPT_READ_TIMEOUT].toInt64(), uint32_t);
+                        } else {
+                            as_error_update(&error, AEROSPIKE_ERR_PARAM, "Unable to set policy: Invalid Value for OPT_READ_TIMEOUT");
+                        }
                     }
-                }
-                if (options.exists(OPT_WRITE_TIMEOUT)) {
-                    if (options[OPT_WRITE_TIMEOUT].isInteger()) {
-                        POLICY_SET_FIELD(scan, timeout, options[OPT_WRITE_TIMEOUT].toInt64(), uint32_t);
-                    } else {
-                        as_error_update(&error, AEROSPIKE_ERR_PARAM, "Unable to set policy: Invalid Value for OPT_WRITE_TIMEOUT");
+                    if (options.exists(OPT_WRITE_TIMEOUT)) {
+                        if (options[OPT_WRITE_TIMEOUT].isInteger()) {
+                            POLICY_SET_FIELD(scan, timeout, options[OPT_WRITE_TIMEOUT].toInt64(), uint32_t);
+                        } else {
+                            as_error_update(&error, AEROSPIKE_ERR_PARAM, "Unable to set policy: Invalid Value for OPT_WRITE_TIMEOUT");
+                        }
                     }
                 }
-            }
-        } else if (strcmp(this->type, "query") == 0) {
-            as_policy_query_copy(&(this->config_p->policies.query), CURRENT_POLICY(query));
+                break;
+            case POLICY_TYPE_QUERY:
+                as_policy_query_copy(&(this->config_p->policies.query), CURRENT_POLICY(query));
 
-            if (options_variant.isArray()) {
-                Array  options = options_variant.toArray();
-                if (options.exists(OPT_READ_TIMEOUT)) {
-                    if (options[OPT_READ_TIMEOUT].isInteger()) {
-                        POLICY_SET_FIELD(query, timeout, options[OPT_READ_TIMEOUT].toInt64(), uint32_t);
-                    } else {
-                        as_error_update(&error, AEROSPIKE_ERR_PARAM, "Unable to set policy: Invalid Value for OPT_READ_TIMEOUT");
+                if (options_variant.isArray()) {
+                    Array  options = options_variant.toArray();
+                    if (options.exists(OPT_READ_TIMEOUT)) {
+                        if (options[OPT_READ_TIMEOUT].isInteger()) {
+                            POLICY_SET_FIELD(query, timeout, options[OPT_READ_TIMEOUT].toInt64(), uint32_t);
+                        } else {
+                            as_error_update(&error, AEROSPIKE_ERR_PARAM, "Unable to set policy: Invalid Value for OPT_READ_TIMEOUT");
+                        }
                     }
                 }
-            }
-        } else if (strcmp(this->type, "info") == 0) {
-            as_policy_info_copy(&(this->config_p->policies.info), CURRENT_POLICY(info));
+                break;
+            case POLICY_TYPE_INFO:
+                as_policy_info_copy(&(this->config_p->policies.info), CURRENT_POLICY(info));
 
-            if (options_variant.isArray()) {
-                Array  options = options_variant.toArray();
-                if (options.exists(OPT_READ_TIMEOUT)) {
-                    if (options[OPT_READ_TIMEOUT].isInteger()) {
-                        POLICY_SET_FIELD(info, timeout, options[OPT_READ_TIMEOUT].toInt64(), uint32_t);
-                    } else {
-                        as_error_update(&error, AEROSPIKE_ERR_PARAM, "Unable to set policy: Invalid Value for OPT_READ_TIMEOUT");
+                if (options_variant.isArray()) {
+                    Array  options = options_variant.toArray();
+                    if (options.exists(OPT_READ_TIMEOUT)) {
+                        if (options[OPT_READ_TIMEOUT].isInteger()) {
+                            POLICY_SET_FIELD(info, timeout, options[OPT_READ_TIMEOUT].toInt64(), uint32_t);
+                        } else {
+                            as_error_update(&error, AEROSPIKE_ERR_PARAM, "Unable to set policy: Invalid Value for OPT_READ_TIMEOUT");
+                        }
                     }
-                }
-                if (options.exists(OPT_WRITE_TIMEOUT)) {
-                    if (options[OPT_WRITE_TIMEOUT].isInteger()) {
-                        POLICY_SET_FIELD(info, timeout, options[OPT_WRITE_TIMEOUT].toInt64(), uint32_t);
-                    } else {
-                        as_error_update(&error, AEROSPIKE_ERR_PARAM, "Unable to set policy: Invalid Value for OPT_READ_TIMEOUT");
+                    if (options.exists(OPT_WRITE_TIMEOUT)) {
+                        if (options[OPT_WRITE_TIMEOUT].isInteger()) {
+                            POLICY_SET_FIELD(info, timeout, options[OPT_WRITE_TIMEOUT].toInt64(), uint32_t);
+                        } else {
+                            as_error_update(&error, AEROSPIKE_ERR_PARAM, "Unable to set policy: Invalid Value for OPT_READ_TIMEOUT");
+                        }
                     }
                 }
-            }
-        } else if(strcmp(this->type, "apply") == 0) {
-            as_policy_apply_copy(&(this->config_p->policies.apply), CURRENT_POLICY(apply));
-            if (options_variant.isArray()) {
-                Array  options = options_variant.toArray();
-                if (options.exists(OPT_WRITE_TIMEOUT)) {
-                    if (options[OPT_WRITE_TIMEOUT].isInteger()) {
-                        POLICY_SET_FIELD(apply, timeout, options[OPT_WRITE_TIMEOUT].toInt64(), uint32_t);
-                    } else {
-                        as_error_update(&error, AEROSPIKE_ERR_CLIENT, "Unable to set policy: Invalid Value for OPT_READ_TIMEOUT");
+                break;
+            case POLICY_TYPE_APPLY:
+                as_policy_apply_copy(&(this->config_p->policies.apply), CURRENT_POLICY(apply));
+                if (options_variant.isArray()) {
+                    Array  options = options_variant.toArray();
+                    if (options.exists(OPT_WRITE_TIMEOUT)) {
+                        if (options[OPT_WRITE_TIMEOUT].isInteger()) {
+                            POLICY_SET_FIELD(apply, timeout, options[OPT_WRITE_TIMEOUT].toInt64(), uint32_t);
+                        } else {
+                            as_error_update(&error, AEROSPIKE_ERR_CLIENT, "Unable to set policy: Invalid Value for OPT_READ_TIMEOUT");
+                        }
                     }
                 }
-            }
+                break;
+            case POLICY_TYPE_ADMIN:
+                as_policy_admin_copy(&(this->config_p->policies.admin), CURRENT_POLICY(admin));
 
-        } else {
-            return as_error_update(&error, AEROSPIKE_ERR_CLIENT,
-                    "Invalid type of policy holder");
+                if (options_variant.isArray()) {
+                    Array  options = options_variant.toArray();
+                    if (options.exists(OPT_WRITE_TIMEOUT)) {
+                        if (options[OPT_WRITE_TIMEOUT].isInteger()) {
+                            POLICY_SET_FIELD(admin, timeout, options[OPT_WRITE_TIMEOUT].toInt64(), uint32_t);
+                        } else {
+                            as_error_update(&error, AEROSPIKE_ERR_PARAM, "Unable to set policy: Invalid Value for OPT_WRITE_TIMEOUT");
+                        }
+                    }
+                }
+                break;
+            default:
+                return as_error_update(&error, AEROSPIKE_ERR_CLIENT,
+                        "Invalid type of policy holder");
         }
         
         if (options_variant.isArray()) {
@@ -435,6 +843,183 @@ namespace HPHP {
         return error.code;
     }
 
+    /*
+     *******************************************************************************************
+     * Function for setting the relevant aerospike policies by copying them from
+     * a precompiled AerospikePolicy, without parsing any options.
+     *
+     * @param compiled_p                The precompiled AerospikePolicy
+     * @param serializer_value          The method level serializer value to be set
+     *                                  by this function
+     * @param global_serializer_val     The class level serializer value to be copied
+     *                                  to method level serializer variable
+     * @param error                     as_error reference to be populated by this function
+     *                                  in case of error
+     *
+     * @return AEROSPIKE_OK if success. Otherwise AEROSPIKE_ERR_*.
+     *******************************************************************************************
+     */
+    as_status PolicyManager::set_compiled_policy(const AerospikePolicy *compiled_p, int16_t *serializer_value,
+            int16_t global_serializer_val, as_error& error)
+    {
+        as_error_reset(&error);
+
+        switch (this->type_id) {
+            case POLICY_TYPE_READ:
+                POLICY_COPY_COMPILED(read, compiled_p);
+                break;
+            case POLICY_TYPE_WRITE:
+                POLICY_COPY_COMPILED(write, compiled_p);
+                break;
+            case POLICY_TYPE_OPERATE:
+                POLICY_COPY_COMPILED(operate, compiled_p);
+                break;
+            case POLICY_TYPE_REMOVE:
+                POLICY_COPY_COMPILED(remove, compiled_p);
+                break;
+            case POLICY_TYPE_INFO:
+                POLICY_COPY_COMPILED(info, compiled_p);
+                break;
+            case POLICY_TYPE_SCAN:
+                POLICY_COPY_COMPILED(scan, compiled_p);
+                break;
+            case POLICY_TYPE_QUERY:
+                POLICY_COPY_COMPILED(query, compiled_p);
+                break;
+            case POLICY_TYPE_APPLY:
+                POLICY_COPY_COMPILED(apply, compiled_p);
+                break;
+            case POLICY_TYPE_ADMIN:
+                POLICY_COPY_COMPILED(admin, compiled_p);
+                break;
+            case POLICY_TYPE_BATCH:
+                POLICY_COPY_COMPILED(batch, compiled_p);
+                break;
+            default:
+                return as_error_update(&error, AEROSPIKE_ERR_CLIENT,
+                        "Invalid type of policy holder");
+        }
+
+        if ((this->type_id == POLICY_TYPE_WRITE || this->type_id == POLICY_TYPE_OPERATE) &&
+                serializer_value) {
+            *serializer_value = compiled_p->has_serializer ?
+                compiled_p->serializer_value : global_serializer_val;
+        }
+
+        if (compiled_p->has_conn_timeout) {
+            this->config_p->conn_timeout_ms = compiled_p->conn_timeout_ms;
+        }
+
+        return error.code;
+    }
+
+    /*
+     *******************************************************************************************
+     * Returns the AerospikePolicy native data of the PHP object held by the
+     * variant, NULL if it is not an AerospikePolicy object.
+     *******************************************************************************************
+     */
+    AerospikePolicy* AerospikePolicy::fromVariant(const Variant& options_variant)
+    {
+        if (!options_variant.isObject()) {
+            return NULL;
+        }
+
+        const Object& object = options_variant.toCObjRef();
+        if (!object->instanceof(s_AerospikePolicy)) {
+            return NULL;
+        }
+        return Native::data<AerospikePolicy>(object.get());
+    }
+
+    /*
+     *******************************************************************************************
+     * Compiles the user's options array against the policy defaults of the given
+     * config. Every as_policy_* is parsed once here through the same code path
+     * as an options array passed to a method, so both behave alike.
+     *
+     * @param config_p      The as_config, the policy defaults of which are to
+     *                      be used.
+     * @param options       The user's options array
+     * @param error         as_error reference to be populated by this function
+     *                      in case of error
+     *
+     * @return AEROSPIKE_OK if success. Otherwise AEROSPIKE_ERR_*.
+     *******************************************************************************************
+     */
+    as_status AerospikePolicy::compile(const as_config *config_p, const Array& options, as_error& error)
+    {
+        /* set_policy() may write the connect timeout, keep the caller's config untouched */
+        as_config       config = *config_p;
+        PolicyManager   policy_manager;
+        int16_t         serializer_option = SERIALIZER_PHP;
+        as_scan         scan;
+
+        as_error_reset(&error);
+        is_compiled = false;
+
+#define COMPILE_POLICY(type)                                                                    \
+        if (AEROSPIKE_OK != policy_manager.initPolicyManager(&this->policies.type, (char *) #type, \
+                    &config, error) ||                                                          \
+                AEROSPIKE_OK != policy_manager.set_policy(&serializer_option, SERIALIZER_PHP,   \
+                    options, error)) {                                                          \
+            return error.code;                                                                  \
+        }
+
+        COMPILE_POLICY(read);
+        COMPILE_POLICY(write);
+        COMPILE_POLICY(operate);
+        COMPILE_POLICY(remove);
+        COMPILE_POLICY(info);
+        COMPILE_POLICY(scan);
+        COMPILE_POLICY(query);
+        COMPILE_POLICY(apply);
+        COMPILE_POLICY(admin);
+        COMPILE_POLICY(batch);
+#undef COMPILE_POLICY
+
+        if (AEROSPIKE_OK != policy_manager.set_generation_value(&this->gen_value, options, error) ||
+                AEROSPIKE_OK != policy_manager.set_ttl_value(&this->ttl_value, options, error) ||
+                AEROSPIKE_OK != policy_manager.set_batch_positional(&this->batch_positional, options, error) ||
+                AEROSPIKE_OK != policy_manager.set_batch_chunking(&this->chunking, options, error) ||
+                AEROSPIKE_OK != policy_manager.set_batch_exists_format(&this->batch_exists_format, options, error) ||
+                AEROSPIKE_OK != policy_manager.set_scan_buffer_size(&this->scan_buffer_size, options, error) ||
+                AEROSPIKE_OK != policy_manager.set_callback_chunk_size(&this->callback_chunk_size, options, error) ||
+                AEROSPIKE_OK != policy_manager.set_scan_partitions(&this->scan_partitions, options, error) ||
+                AEROSPIKE_OK != policy_manager.set_max_records(&this->max_records, options, error)) {
+            return error.code;
+        }
+
+        as_scan_init(&scan, "", "");
+        if (AEROSPIKE_OK != set_scan_policies(&scan, options, error)) {
+            as_scan_destroy(&scan);
+            return error.code;
+        }
+        scan_priority = scan.priority;
+        scan_percent = scan.percent;
+        scan_concurrent = scan.concurrent;
+        scan_no_bins = scan.no_bins;
+        as_scan_destroy(&scan);
+
+        has_serializer = options.exists(OPT_SERIALIZER) && options[OPT_SERIALIZER].isInteger();
+        serializer_value = has_serializer ? options[OPT_SERIALIZER].toInt16() : SERIALIZER_PHP;
+        has_gen_value = options.exists(OPT_POLICY_GEN);
+        has_ttl_value = options.exists(OPT_TTL);
+        has_batch_positional = options.exists(OPT_BATCH_POSITIONAL);
+        has_batch_chunking = options.exists(OPT_BATCH_CHUNK_SIZE) ||
+            options.exists(OPT_BATCH_MAX_IN_FLIGHT) || options.exists(OPT_BATCH_CHUNK_RETRIES) ||
+            options.exists(OPT_BATCH_RETRY_FAILED_KEYS);
+        has_batch_exists_format = options.exists(OPT_BATCH_EXISTS_FORMAT);
+        has_scan_buffer_size = options.exists(OPT_SCAN_BUFFER_SIZE);
+        has_callback_chunk_size = options.exists(OPT_CALLBACK_CHUNK_SIZE);
+        has_max_records = options.exists(OPT_MAX_RECORDS);
+        has_conn_timeout = config.conn_timeout_ms != config_p->conn_timeout_ms;
+        conn_timeout_ms = config.conn_timeout_ms;
+
+        is_compiled = true;
+        return error.code;
+    }
+
     /*
      *******************************************************************************************
      * Function for setting the relevant aerospike global defaults by using the user's
@@ -550,6 +1135,19 @@ namespace HPHP {
     {
         as_error_reset(&error);
 
+        if (options_variant.isObject()) {
+            AerospikePolicy *compiled_p = AerospikePolicy::fromVariant(options_variant);
+            if (!compiled_p || !compiled_p->is_compiled) {
+                return as_error_update(&error, AEROSPIKE_ERR_PARAM,
+                        "Policy options must be of type an Array or a valid AerospikePolicy");
+            }
+            as_scan_set_priority(scan, compiled_p->scan_priority);
+            as_scan_set_percent(scan, compiled_p->scan_percent);
+            as_scan_set_concurrent(scan, compiled_p->scan_concurrent);
+            as_scan_set_nobins(scan, compiled_p->scan_no_bins);
+            return error.code;
+        }
+
         if (!options_variant.isNull() && !options_variant.isArray()) {
             return as_error_update(&error, AEROSPIKE_ERR_PARAM,
                     "Policy options must be of type an Array");
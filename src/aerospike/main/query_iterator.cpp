@@ -0,0 +1,70 @@
+#include "query_iterator.h"
+#include "scan_operation.h"
+#include "policy.h"
+
+namespace HPHP {
+
+    /*
+     *******************************************************************************************
+     * Destructor for AerospikeQueryIterator, stops the query if it is still
+     * running, before the as_query it reads is destroyed.
+     *******************************************************************************************
+     */
+    AerospikeQueryIterator::~AerospikeQueryIterator()
+    {
+        close();
+        if (query_initialized) {
+            as_query_destroy(&query);
+        }
+    }
+
+    /*
+     *******************************************************************************************
+     * Validates the query and starts it through the RecordStream.
+     *
+     * @param db                    The Aerospike object, kept alive by the
+     *                              iterator.
+     * @param as_ref_p              aerospike_ref of the connection of db.
+     * @param ns                    Namespace to be queried.
+     * @param set                   Set to be queried.
+     * @param where                 The where predicate, an empty array for
+     *                              none.
+     * @param bins                  Optional array of the bins to be read.
+     * @param query_policy          The as_policy_query of the query.
+     * @param buffer_size           The max no. of records buffered.
+     * @param max_records           The max no. of records iterated, 0 for no
+     *                              limit.
+     * @param error                 as_error reference to be populated by this
+     *                              method in case of error.
+     *
+     * @return AEROSPIKE_OK if SUCCESS. Otherwise AEROSPIKE_ERR_*.
+     *******************************************************************************************
+     */
+    as_status AerospikeQueryIterator::init(const Object& db, aerospike_ref *as_ref_p,
+            const Variant& ns, const Variant& set, const Variant& where,
+            const Variant& bins, const as_policy_query& query_policy,
+            uint32_t buffer_size, uint64_t max_records, as_error& error)
+    {
+        as_error_reset(&error);
+
+        if (is_initialized) {
+            return as_error_update(&error, AEROSPIKE_ERR_CLIENT,
+                    "AerospikeQueryIterator is already initialized");
+        }
+
+        if (AEROSPIKE_OK != initialize_query(&query, ns, set, where, bins, error)) {
+            return error.code;
+        }
+        query_initialized = true;
+
+        this->db = db;
+        this->query_policy = query_policy;
+        is_initialized = true;
+
+        auto run_query = [this, as_ref_p] (as_error& job_error) {
+            aerospike_query_foreach(as_ref_p->as_p, &job_error, &this->query_policy,
+                    &this->query, RecordStream::callback, &this->stream);
+        };
+        return stream.start(as_ref_p, buffer_size, max_records, run_query, error);
+    }
+} // namespace HPHP
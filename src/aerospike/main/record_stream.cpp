@@ -0,0 +1,300 @@
+#include "record_stream.h"
+#include "conversions.h"
+
+#include <chrono>
+#include <system_error>
+
+namespace HPHP {
+
+    /*
+     *******************************************************************************************
+     * Returns a heap allocated copy of a record of a scan/query which owns
+     * all of its data, since the record given to the callback is only valid
+     * within the callback.
+     *
+     * @param record_p      The as_record to be copied.
+     * @return the copy, or NULL if the copy failed.
+     *******************************************************************************************
+     */
+    static as_record* as_record_to_owned_as_record(as_record *record_p)
+    {
+        as_record *owned_p = as_record_new(record_p->bins.size);
+
+        if (!owned_p) {
+            return NULL;
+        }
+        owned_p->gen = record_p->gen;
+        owned_p->ttl = record_p->ttl;
+        as_key_to_owned_as_key(record_p->key, owned_p->key);
+
+        for (uint16_t iter = 0; iter < record_p->bins.size; iter++) {
+            as_bin *bin_p = &record_p->bins.entries[iter];
+            if (!bin_p->valuep) {
+                as_record_set_nil(owned_p, bin_p->name);
+                continue;
+            }
+            as_val *value_p = as_val_to_owned_as_val((as_val *) bin_p->valuep);
+            if (!value_p) {
+                as_record_destroy(owned_p);
+                return NULL;
+            }
+            as_record_set(owned_p, bin_p->name, (as_bin_value *) value_p);
+        }
+        return owned_p;
+    }
+
+    /*
+     *******************************************************************************************
+     * Constructor for RecordStream.
+     *******************************************************************************************
+     */
+    RecordStream::RecordStream()
+    {
+        as_error_init(&error);
+    }
+
+    /*
+     *******************************************************************************************
+     * Destructor for RecordStream, stops the scan/query if it is still
+     * running and destroys the buffered records.
+     *******************************************************************************************
+     */
+    RecordStream::~RecordStream()
+    {
+        close();
+    }
+
+    /*
+     *******************************************************************************************
+     * Runs a scan/query on a thread of its own.
+     *
+     * @param as_ref_p              aerospike_ref of the connection of the
+     *                              scan/query.
+     * @param capacity              The max no. of records buffered.
+     * @param max_records           The max no. of records streamed, 0 for
+     *                              no limit.
+     * @param run                   Runs the scan/query with callback() as
+     *                              its callback and the stream as its udata,
+     *                              populating the given as_error.
+     * @param error                 as_error reference to be populated by this
+     *                              method in case of error.
+     *
+     * @return AEROSPIKE_OK if SUCCESS. Otherwise AEROSPIKE_ERR_*.
+     *******************************************************************************************
+     */
+    as_status RecordStream::start(aerospike_ref *as_ref_p, uint32_t capacity,
+            uint64_t max_records, std::function<void(as_error&)> run, as_error& error)
+    {
+        as_error_reset(&error);
+
+        if (is_running) {
+            return as_error_update(&error, AEROSPIKE_ERR_CLIENT,
+                    "The record stream is already started");
+        }
+
+        this->as_ref_p = as_ref_p;
+        this->capacity = capacity;
+        this->max_records = max_records;
+        is_running = true;
+
+        as_ref_p->ref_async_commands++;
+        auto run_stream = [this, run] {
+            as_error job_error;
+            as_error_init(&job_error);
+            run(job_error);
+            this->as_ref_p->ref_async_commands--;
+
+            std::lock_guard<std::mutex> guard(lock);
+            bool is_limited = this->max_records && n_records >= this->max_records;
+            if (job_error.code != AEROSPIKE_OK && this->error.code == AEROSPIKE_OK &&
+                    !is_limited) {
+                as_error_copy(&this->error, &job_error);
+            }
+            is_running = false;
+            cond.notify_all();
+        };
+        try {
+            worker = std::thread(run_stream);
+        } catch (const std::system_error&) {
+            as_ref_p->ref_async_commands--;
+            is_running = false;
+            return as_error_update(&error, AEROSPIKE_ERR_CLIENT,
+                    "Unable to start the record stream");
+        }
+        return error.code;
+    }
+
+    /*
+     *******************************************************************************************
+     * Callback for each record of the scan/query, invoked by the C client
+     * threads.
+     *
+     * @param val_p             An as_val of record type, NULL at the end of
+     *                          the scan/query.
+     * @param udata             The RecordStream.
+     * @return true to go on with the scan/query, false to stop it.
+     *******************************************************************************************
+     */
+    bool RecordStream::callback(const as_val *val_p, void *udata)
+    {
+        RecordStream    *stream_p = (RecordStream *) udata;
+
+        if (!val_p) {
+            return true;
+        }
+
+        as_record *record_p = as_record_fromval(val_p);
+        if (!record_p) {
+            return true;
+        }
+
+        as_record *owned_p = as_record_to_owned_as_record(record_p);
+        if (!owned_p) {
+            std::lock_guard<std::mutex> guard(stream_p->lock);
+            if (stream_p->error.code == AEROSPIKE_OK) {
+                as_error_update(&stream_p->error, AEROSPIKE_ERR_CLIENT,
+                        "Unable to copy a streamed record");
+            }
+            return false;
+        }
+        return stream_p->push(owned_p);
+    }
+
+    /*
+     *******************************************************************************************
+     * Appends a record to the buffer, waiting while it is full. Called by the
+     * C client threads only.
+     *
+     * @param record_p              The owned record, destroyed if it is not
+     *                              buffered.
+     * @return true if the record is buffered and the scan/query is to go on,
+     * false if the stream is closed, its connection was closed meanwhile or
+     * max_records records were buffered.
+     *******************************************************************************************
+     */
+    bool RecordStream::push(as_record *record_p)
+    {
+        std::unique_lock<std::mutex> guard(lock);
+        bool is_disconnected = false;
+
+        if (max_records && n_records >= max_records) {
+            guard.unlock();
+            as_record_destroy(record_p);
+            return false;
+        }
+        /*
+         * Checked on every push, so that close() of the connection stops the
+         * scan/query at once rather than once the buffer is full.
+         */
+        while (!is_closed) {
+            if (as_ref_p->ref_php_object < 1) {
+                if (error.code == AEROSPIKE_OK) {
+                    as_error_update(&error, AEROSPIKE_ERR_CLIENT,
+                            "Connection closed while streaming records");
+                }
+                is_disconnected = true;
+                break;
+            }
+            if (buffer.size() < capacity) {
+                break;
+            }
+            cond.wait_for(guard, std::chrono::milliseconds(RECORD_STREAM_POLL_MS));
+        }
+        if (is_closed || is_disconnected) {
+            guard.unlock();
+            as_record_destroy(record_p);
+            return false;
+        }
+        buffer.push_back(record_p);
+        n_records++;
+        cond.notify_all();
+        return !max_records || n_records < max_records;
+    }
+
+    /*
+     *******************************************************************************************
+     * Takes the next record, waiting for it if needed. Called on the request
+     * thread only.
+     *
+     * @param record_pp             Populated with the record, to be destroyed
+     *                              by the caller.
+     * @param error                 as_error reference populated with the error
+     *                              of the scan/query, if any, once it ended.
+     *
+     * @return true if there is a next record. Otherwise false.
+     *******************************************************************************************
+     */
+    bool RecordStream::pop(as_record **record_pp, as_error& error)
+    {
+        std::unique_lock<std::mutex> guard(lock);
+
+        cond.wait(guard, [this] { return is_closed || !buffer.empty() || !is_running; });
+        if (is_closed) {
+            return false;
+        }
+        if (buffer.empty()) {
+            if (this->error.code != AEROSPIKE_OK) {
+                as_error_copy(&error, &this->error);
+            }
+            return false;
+        }
+        *record_pp = buffer.front();
+        buffer.pop_front();
+        cond.notify_all();
+        return true;
+    }
+
+    /*
+     *******************************************************************************************
+     * Passes each record to a scan/query callback on the request thread, the
+     * way aerospike_scan_foreach()/aerospike_query_foreach() would, and
+     * closes the stream as soon as the callback returns false.
+     *
+     * @param record_cb             The scan/query callback.
+     * @param udata                 The udata of record_cb.
+     * @param error                 as_error reference populated with the error
+     *                              of the scan/query, if any.
+     *
+     * @return AEROSPIKE_OK if SUCCESS. Otherwise AEROSPIKE_ERR_*.
+     *******************************************************************************************
+     */
+    as_status RecordStream::foreach(bool (*record_cb)(const as_val *, void *),
+            void *udata, as_error& error)
+    {
+        as_record *record_p = NULL;
+
+        while (pop(&record_p, error)) {
+            bool do_continue = record_cb((as_val *) record_p, udata);
+            as_record_destroy(record_p);
+            if (!do_continue) {
+                close();
+                break;
+            }
+        }
+        return error.code;
+    }
+
+    /*
+     *******************************************************************************************
+     * Stops the scan/query if it is still running, waits for it to end and
+     * destroys the buffered records. The stream yields no more records.
+     *******************************************************************************************
+     */
+    void RecordStream::close()
+    {
+        std::unique_lock<std::mutex> guard(lock);
+        is_closed = true;
+        cond.notify_all();
+        cond.wait(guard, [this] { return !is_running; });
+
+        for (as_record *record_p : buffer) {
+            as_record_destroy(record_p);
+        }
+        buffer.clear();
+        guard.unlock();
+
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+} // namespace HPHP
@@ -0,0 +1,124 @@
+#include "record_stream_iterator.h"
+#include "conversions.h"
+
+namespace HPHP {
+
+    /*
+     *******************************************************************************************
+     * Constructor for RecordStreamIterator.
+     *******************************************************************************************
+     */
+    RecordStreamIterator::RecordStreamIterator()
+    {
+        as_error_init(&error);
+    }
+
+    /*
+     *******************************************************************************************
+     * Destructor for RecordStreamIterator, stops the scan/query if it is
+     * still running and destroys the buffered records.
+     *******************************************************************************************
+     */
+    RecordStreamIterator::~RecordStreamIterator()
+    {
+        close();
+    }
+
+    /*
+     *******************************************************************************************
+     * Converts the next buffered record into the current record, waiting for
+     * it if needed. Called on the request thread only.
+     *
+     * @return true if there is a next record. Otherwise false.
+     *******************************************************************************************
+     */
+    bool RecordStreamIterator::fetch_record()
+    {
+        as_record *record_p = NULL;
+        as_error stream_error;
+        as_error_init(&stream_error);
+        if (!stream.pop(&record_p, stream_error)) {
+            if (stream_error.code != AEROSPIKE_OK && error.code == AEROSPIKE_OK) {
+                as_error_copy(&error, &stream_error);
+            }
+            return false;
+        }
+
+        Array php_rec = Array::Create();
+        as_error conversion_error;
+        as_error_init(&conversion_error);
+        if (AEROSPIKE_OK != as_record_to_php_record(record_p, &record_p->key,
+                    php_rec, NULL, conversion_error)) {
+            if (error.code == AEROSPIKE_OK) {
+                as_error_copy(&error, &conversion_error);
+            }
+            record = init_null();
+        } else {
+            record = php_rec;
+        }
+        as_record_destroy(record_p);
+
+        has_record = true;
+        position++;
+        return true;
+    }
+
+    bool RecordStreamIterator::valid()
+    {
+        if (!is_initialized) {
+            return false;
+        }
+        return has_record || fetch_record();
+    }
+
+    Variant RecordStreamIterator::current()
+    {
+        if (!valid()) {
+            return init_null();
+        }
+        return record;
+    }
+
+    Variant RecordStreamIterator::key()
+    {
+        if (!valid()) {
+            return init_null();
+        }
+        return position;
+    }
+
+    void RecordStreamIterator::next()
+    {
+        if (!has_record) {
+            valid();
+        }
+        has_record = false;
+        record = init_null();
+    }
+
+    /*
+     *******************************************************************************************
+     * Stops the scan/query if it is still running, waits for it to end and
+     * destroys the buffered records. The iterator yields no more records.
+     *******************************************************************************************
+     */
+    void RecordStreamIterator::close()
+    {
+        stream.close();
+        has_record = false;
+        record = init_null();
+    }
+
+    /*
+     *******************************************************************************************
+     * Returns the message of the first error met, an empty string if none.
+     *******************************************************************************************
+     */
+    String RecordStreamIterator::getErrorMessage() const
+    {
+        if (error.code == AEROSPIKE_OK) {
+            return empty_string();
+        }
+        return String(error.message, CopyString);
+    }
+} // namespace HPHP
@@ -0,0 +1,72 @@
+#include "scan_iterator.h"
+#include "scan_operation.h"
+#include "policy.h"
+
+namespace HPHP {
+
+    /*
+     *******************************************************************************************
+     * Destructor for AerospikeScanIterator, stops the scan if it is still
+     * running, before the as_scan it reads is destroyed.
+     *******************************************************************************************
+     */
+    AerospikeScanIterator::~AerospikeScanIterator()
+    {
+        close();
+        if (scan_initialized) {
+            as_scan_destroy(&scan);
+        }
+    }
+
+    /*
+     *******************************************************************************************
+     * Validates the scan and starts it through the RecordStream.
+     *
+     * @param db                    The Aerospike object, kept alive by the
+     *                              iterator.
+     * @param as_ref_p              aerospike_ref of the connection of db.
+     * @param ns                    Namespace to be scanned.
+     * @param set                   Set to be scanned.
+     * @param bins                  Optional array of the bins to be read.
+     * @param options               The user's optional scan options.
+     * @param scan_policy           The as_policy_scan of the scan.
+     * @param buffer_size           The max no. of records buffered.
+     * @param max_records           The max no. of records iterated, 0 for no
+     *                              limit.
+     * @param error                 as_error reference to be populated by this
+     *                              method in case of error.
+     *
+     * @return AEROSPIKE_OK if SUCCESS. Otherwise AEROSPIKE_ERR_*.
+     *******************************************************************************************
+     */
+    as_status AerospikeScanIterator::init(const Object& db, aerospike_ref *as_ref_p,
+            const Variant& ns, const Variant& set, const Variant& bins,
+            const Variant& options, const as_policy_scan& scan_policy,
+            uint32_t buffer_size, uint64_t max_records, as_error& error)
+    {
+        as_error_reset(&error);
+
+        if (is_initialized) {
+            return as_error_update(&error, AEROSPIKE_ERR_CLIENT,
+                    "AerospikeScanIterator is already initialized");
+        }
+
+        if (AEROSPIKE_OK != initialize_scan(&scan, ns, set, bins, error)) {
+            return error.code;
+        }
+        scan_initialized = true;
+        if (AEROSPIKE_OK != set_scan_policies(&scan, options, error)) {
+            return error.code;
+        }
+
+        this->db = db;
+        this->scan_policy = scan_policy;
+        is_initialized = true;
+
+        auto run_scan = [this, as_ref_p] (as_error& job_error) {
+            aerospike_scan_foreach(as_ref_p->as_p, &job_error, &this->scan_policy,
+                    &this->scan, RecordStream::callback, &this->stream);
+        };
+        return stream.start(as_ref_p, buffer_size, max_records, run_scan, error);
+    }
+} // namespace HPHP
@@ -0,0 +1,177 @@
+#include "scan_job.h"
+#include "ext_aerospike.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cinttypes>
+#include <thread>
+
+namespace HPHP {
+
+    /*
+     *******************************************************************************************
+     * Converts an as_scan_info into the PHP array returned by scanInfo() and
+     * AerospikeScanJob::info().
+     *
+     * @param scan_info             The as_scan_info to be converted.
+     * @return the array of progress_pct, records_scanned and status.
+     *******************************************************************************************
+     */
+    Array as_scan_info_to_php_array(const as_scan_info& scan_info)
+    {
+        Array php_scan_info = Array::Create();
+        php_scan_info.set(s_progress_pct, (int64_t)scan_info.progress_pct);
+        php_scan_info.set(s_records_scanned, (int64_t)scan_info.records_scanned);
+        php_scan_info.set(s_status, (int64_t)scan_info.status);
+        return php_scan_info;
+    }
+
+    /*
+     *******************************************************************************************
+     * Constructor for AerospikeScanJob.
+     *******************************************************************************************
+     */
+    AerospikeScanJob::AerospikeScanJob()
+    {
+        as_error_init(&error);
+    }
+
+    /*
+     *******************************************************************************************
+     * Binds the job to a background scan.
+     *
+     * @param db                    The Aerospike object which started the
+     *                              scan, kept alive by the job.
+     * @param scan_id               The id of the background scan.
+     * @param info_policy           The as_policy_info of each poll.
+     *******************************************************************************************
+     */
+    void AerospikeScanJob::init(const Object& db, uint64_t scan_id,
+            const as_policy_info& info_policy)
+    {
+        this->db = db;
+        this->scan_id = scan_id;
+        this->info_policy = info_policy;
+        is_initialized = true;
+    }
+
+    /*
+     *******************************************************************************************
+     * Returns the aerospike instance of the connection of the job, NULL if
+     * the connection was closed meanwhile.
+     *
+     * @param error                 as_error reference to be populated by this
+     *                              method in case of error.
+     *******************************************************************************************
+     */
+    aerospike* AerospikeScanJob::get_connection(as_error& error) const
+    {
+        if (!is_initialized) {
+            as_error_update(&error, AEROSPIKE_ERR_CLIENT,
+                    "AerospikeScanJob is not initialized");
+            return NULL;
+        }
+
+        auto data = Native::data<Aerospike>(db.get());
+        if (!data->as_ref_p || !data->as_ref_p->as_p) {
+            as_error_update(&error, AEROSPIKE_ERR_CLIENT,
+                    "Invalid aerospike connection object");
+            return NULL;
+        }
+        if (!data->is_connected) {
+            as_error_update(&error, AEROSPIKE_ERR_CLUSTER,
+                    "AerospikeScanJob: connection not established");
+            return NULL;
+        }
+        return data->as_ref_p->as_p;
+    }
+
+    /*
+     *******************************************************************************************
+     * Gets the status of the background scan once.
+     *
+     * @param scan_info             Populated with the status of the scan.
+     *
+     * @return AEROSPIKE_OK if SUCCESS. Otherwise AEROSPIKE_ERR_*.
+     *******************************************************************************************
+     */
+    as_status AerospikeScanJob::info(as_scan_info& scan_info)
+    {
+        as_error_reset(&error);
+
+        aerospike *as_p = get_connection(error);
+        if (as_p) {
+            aerospike_scan_info(as_p, &error, &info_policy, scan_id, &scan_info);
+        }
+        return error.code;
+    }
+
+    /*
+     *******************************************************************************************
+     * Polls the status of the background scan until it completes, unlike
+     * aerospike_scan_wait(), giving up once timeout_ms elapsed.
+     *
+     * @param timeout_ms            The max time to wait in milliseconds, 0
+     *                              to wait for as long as the scan runs.
+     * @param interval_ms           The interval between two polls in
+     *                              milliseconds.
+     *
+     * @return AEROSPIKE_OK once the scan completed, AEROSPIKE_ERR_SCAN_ABORTED
+     * if it was aborted, AEROSPIKE_ERR_TIMEOUT if it is still running after
+     * timeout_ms. Otherwise AEROSPIKE_ERR_*.
+     *******************************************************************************************
+     */
+    as_status AerospikeScanJob::wait(int64_t timeout_ms, int64_t interval_ms)
+    {
+        as_scan_info    scan_info;
+        auto            deadline = std::chrono::steady_clock::now() +
+            std::chrono::milliseconds(timeout_ms);
+
+        as_error_reset(&error);
+
+        if (timeout_ms < 0 || interval_ms <= 0) {
+            return as_error_update(&error, AEROSPIKE_ERR_PARAM,
+                    "Invalid timeout or interval for the scan job");
+        }
+
+        while (AEROSPIKE_OK == info(scan_info)) {
+            if (scan_info.status == AS_SCAN_STATUS_COMPLETED) {
+                break;
+            }
+            if (scan_info.status == AS_SCAN_STATUS_ABORTED) {
+                as_error_update(&error, AEROSPIKE_ERR_SCAN_ABORTED,
+                        "Scan job %" PRIu64 " was aborted", scan_id);
+                break;
+            }
+
+            auto sleep_for = std::chrono::milliseconds(interval_ms);
+            if (timeout_ms) {
+                auto now = std::chrono::steady_clock::now();
+                if (now >= deadline) {
+                    as_error_update(&error, AEROSPIKE_ERR_TIMEOUT,
+                            "Scan job %" PRIu64 " did not complete within %" PRId64 " ms",
+                            scan_id, timeout_ms);
+                    break;
+                }
+                sleep_for = std::min(sleep_for,
+                        std::chrono::duration_cast<std::chrono::milliseconds>(deadline - now));
+            }
+            std::this_thread::sleep_for(sleep_for);
+        }
+        return error.code;
+    }
+
+    /*
+     *******************************************************************************************
+     * Returns the message of the error of the last call, an empty string if
+     * none.
+     *******************************************************************************************
+     */
+    String AerospikeScanJob::getErrorMessage() const
+    {
+        if (error.code == AEROSPIKE_OK) {
+            return empty_string();
+        }
+        return String(error.message, CopyString);
+    }
+} // namespace HPHP
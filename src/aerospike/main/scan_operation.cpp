@@ -4,12 +4,120 @@
 
 #include "hphp/runtime/base/builtin-functions.h"
 #include "hphp/runtime/base/program-functions.h"
+#include "hphp/runtime/base/packed-array.h"
+
+#include <algorithm>
+#include <cstring>
+#include <string>
+#include <vector>
 
 namespace HPHP {
+    /*
+     * Max no. of records a chunk of a chunked scan/query is reserved for up
+     * front, it grows past it as records are appended.
+     */
+#define SCAN_QUERY_CHUNK_RESERVE_MAX 1024
+
+    /*
+     *******************************************************************************************
+     * Calls the PHP user callback function of a scan/query with a record, or
+     * a list of records, and sets udata.stopped if it returns false.
+     *
+     * @param udata         foreach_callback_user_udata reference which
+     *                      contains the PHP user callback function.
+     * @param php_value     The argument of the PHP user callback function.
+     * @return true to go on with the scan/query, false to stop it.
+     *******************************************************************************************
+     */
+    static bool call_scan_query_function(foreach_callback_user_udata& udata,
+            const Array& php_value)
+    {
+        Array php_args = Array::Create();
+        php_args.append(php_value);
+        Variant ret = vm_call_user_func(udata.function, php_args);
+
+        if (ret.isBoolean() && ret.toBoolean() == false) {
+            udata.stopped = true;
+        }
+        return !udata.stopped;
+    }
+
+    /*
+     *******************************************************************************************
+     * Creates an empty chunk of records reserved for chunk_size records, up
+     * to SCAN_QUERY_CHUNK_RESERVE_MAX, since a scan/query may return far
+     * fewer records than chunk_size.
+     *******************************************************************************************
+     */
+    static Array create_scan_query_chunk(uint32_t chunk_size)
+    {
+        return Array::attach(PackedArray::MakeReserve(
+                    std::min(chunk_size, (uint32_t) SCAN_QUERY_CHUNK_RESERVE_MAX)));
+    }
+
+    /*
+     *******************************************************************************************
+     * Ends a scan/query once all the records were passed to
+     * scan_query_callback(): passes the records left in the chunk of a
+     * chunked scan/query to the PHP user callback function, unless the
+     * function stopped the scan/query, and clears the status of the abort of
+     * a scan/query which the function stopped or which stopped at
+     * udata.max_records, which is not an error. A stopped scan/query thus
+     * returns AEROSPIKE_OK whether it ran on this thread or through a
+     * RecordStream.
+     *
+     * @param udata         foreach_callback_user_udata reference which
+     *                      contains the PHP user callback function.
+     *******************************************************************************************
+     */
+    void finish_scan_query(foreach_callback_user_udata& udata)
+    {
+        if (udata.limit_reached || udata.stopped) {
+            as_error_reset(&udata.error);
+        }
+        if (!udata.stopped && !udata.chunk.isNull() && !udata.chunk.empty()) {
+            Array php_chunk = udata.chunk;
+            udata.chunk = Array();
+            call_scan_query_function(udata, php_chunk);
+        }
+    }
+
+    /*
+     *******************************************************************************************
+     * Passes a record to the PHP user callback function on its own, or
+     * appends it to the chunk of records passed once udata.chunk_size records
+     * are gathered if it is set.
+     *
+     * @param udata         foreach_callback_user_udata reference which
+     *                      contains the PHP user callback function.
+     * @param php_record    The record.
+     * @return true to go on with the scan/query, false to stop it.
+     *******************************************************************************************
+     */
+    static bool deliver_scan_query_record(foreach_callback_user_udata& udata,
+            const Array& php_record)
+    {
+        if (!udata.chunk_size) {
+            return call_scan_query_function(udata, php_record);
+        }
+
+        if (udata.chunk.isNull()) {
+            udata.chunk = create_scan_query_chunk(udata.chunk_size);
+        }
+        udata.chunk.append(php_record);
+        if (udata.chunk.size() < udata.chunk_size) {
+            return true;
+        }
+        Array php_chunk = udata.chunk;
+        udata.chunk = create_scan_query_chunk(udata.chunk_size);
+        return call_scan_query_function(udata, php_chunk);
+    }
 
     /*
      *******************************************************************************************
      * Callback function for each record scanned by aerospike_scan_foreach() API
+     * The record is passed on by deliver_scan_query_record(), and the
+     * scan/query is stopped once udata.max_records records were, if set.
      *
      * @param val_p         An as_val of record type
      * @param udata_p       foreach_callback_user_udata pointer which contains
@@ -35,16 +143,308 @@ namespace HPHP {
 
         as_record_to_php_record(record_p, &record_p->key, temp_php_record, NULL, conversion_data_p->error);
 
-        Array php_record = Array::Create();
-        php_record.append(temp_php_record);
-        Variant ret = vm_call_user_func(conversion_data_p->function, php_record);
+        if (conversion_data_p->stopped || conversion_data_p->limit_reached) {
+            return false;
+        }
+        bool do_continue = deliver_scan_query_record(*conversion_data_p, temp_php_record);
+        if (conversion_data_p->max_records &&
+                ++conversion_data_p->n_records >= conversion_data_p->max_records) {
+            conversion_data_p->limit_reached = true;
+            return false;
+        }
+        return do_continue;
+    }
 
-        bool do_continue = true;
-        if (ret.isBoolean() && ret.toBoolean() == false) {
-            do_continue = false;
+    /*
+     ************************************************************************************
+     * Structure holding the partition range of a scan and the udata of
+     * scan_query_callback(), for partition_filter_callback().
+     ************************************************************************************
+     */
+    typedef struct partition_filter_udata {
+        const scan_partition_range *range_p;
+        foreach_callback_user_udata *udata_p;
+    } partition_filter_udata;
+
+    /*
+     *******************************************************************************************
+     * Callback function for each record scanned by aerospike_scan_node(),
+     * passing on to scan_query_callback() the records whose partition, given
+     * by the first two bytes of their digest, is within the partition range.
+     *
+     * @param val_p         An as_val of record type
+     * @param udata         partition_filter_udata pointer
+     * @return true to go on with the scan, false to stop it.
+     *******************************************************************************************
+     */
+    static bool partition_filter_callback(const as_val *val_p, void *udata)
+    {
+        partition_filter_udata  *filter_p = (partition_filter_udata *) udata;
+
+        if (!val_p) {
+            return true;
         }
 
-        return do_continue;
+        as_record *record_p = as_record_fromval(val_p);
+        if (record_p && record_p->key.digest.init) {
+            const uint8_t *digest = record_p->key.digest.value;
+            uint16_t partition_id = (digest[0] | (digest[1] << 8)) & (SCAN_PARTITIONS_COUNT - 1);
+            if (partition_id < filter_p->range_p->begin || partition_id > filter_p->range_p->end) {
+                return true;
+            }
+        }
+        return scan_query_callback(val_p, filter_p->udata_p);
+    }
+
+    /*
+     *******************************************************************************************
+     * Checks whether a node is listed in the nodes completed by a scan.
+     *
+     * @param nodes_done    The names of the nodes completed.
+     * @param node_name     The name of the node.
+     * @return true if the node is completed. Otherwise false.
+     *******************************************************************************************
+     */
+    static bool is_scan_node_done(const Array& nodes_done, const char *node_name)
+    {
+        for (ArrayIter iter(nodes_done); iter; ++iter) {
+            if (!strcmp(iter.second().toString().c_str(), node_name)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    /*
+     *******************************************************************************************
+     * Gets the names of the nodes of the cluster, sorted.
+     *
+     * @param as_p          The aerospike instance.
+     * @param node_names    Populated with the names of the nodes.
+     *******************************************************************************************
+     */
+    static void get_scan_nodes(aerospike *as_p, std::vector<std::string>& node_names)
+    {
+        as_nodes *nodes_p = as_nodes_reserve(as_p->cluster);
+        for (uint32_t iter = 0; iter < nodes_p->size; iter++) {
+            node_names.push_back(nodes_p->array[iter]->name);
+        }
+        as_nodes_release(nodes_p);
+        std::sort(node_names.begin(), node_names.end());
+    }
+
+    /*
+     *******************************************************************************************
+     * Checks that the nodes of the cluster are still the ones a scan began
+     * with. The partitions of a node which joined or left the cluster
+     * migrate to other nodes, so resuming the scan from its completed nodes
+     * would skip or repeat their records.
+     *
+     * @param as_p          The aerospike instance.
+     * @param nodes         The sorted names of the nodes the scan began with.
+     * @param error         as_error reference to be populated by this function
+     *                      in case of error
+     * @return AEROSPIKE_OK if the nodes are the same. Otherwise
+     * AEROSPIKE_ERR_CLUSTER_CHANGE.
+     *******************************************************************************************
+     */
+    static as_status check_scan_nodes(aerospike *as_p, const Array& nodes, as_error& error)
+    {
+        std::vector<std::string>    node_names;
+        bool                        is_same;
+        size_t                      idx = 0;
+
+        get_scan_nodes(as_p, node_names);
+        is_same = (node_names.size() == (size_t) nodes.size());
+        for (ArrayIter iter(nodes); is_same && iter; ++iter, ++idx) {
+            is_same = !strcmp(iter.second().toString().c_str(), node_names[idx].c_str());
+        }
+        if (!is_same) {
+            return as_error_update(&error, AEROSPIKE_ERR_CLUSTER_CHANGE,
+                    "Scan failed because the cluster nodes changed since it began");
+        }
+        return error.code;
+    }
+
+    /*
+     *******************************************************************************************
+     * Function to validate a scan cursor passed in to resume a scan and to
+     * read the partition range, the nodes of the cluster and the completed
+     * nodes out of it.
+     *
+     * @param cursor        The scan cursor returned by a previous scan.
+     * @param scan_p        The as_scan to be resumed.
+     * @param range         The partition range set by the user's options, if
+     *                      any, populated with the one of the cursor.
+     * @param nodes_done    Populated with the names of the completed nodes.
+     * @param nodes         Populated with the names of the nodes of the
+     *                      cluster when the scan began.
+     * @param error         as_error reference to be populated by this function
+     *                      in case of error
+     * @return AEROSPIKE_OK if success. Otherwise AEROSPIKE_ERR_*.
+     *******************************************************************************************
+     */
+    as_status parse_scan_cursor(const Variant& cursor, const as_scan *scan_p,
+            scan_partition_range& range, Array& nodes_done, Array& nodes, as_error& error)
+    {
+        as_error_reset(&error);
+
+        if (!cursor.isArray()) {
+            return as_error_update(&error, AEROSPIKE_ERR_PARAM,
+                    "Scan cursor must be an array");
+        }
+
+        Array php_cursor = cursor.toArray();
+        if (!php_cursor.exists(s_ns) || !php_cursor[s_ns].isString() ||
+                !php_cursor.exists(s_set) || !php_cursor[s_set].isString() ||
+                !php_cursor.exists(s_begin) || !php_cursor[s_begin].isInteger() ||
+                !php_cursor.exists(s_end) || !php_cursor[s_end].isInteger() ||
+                !php_cursor.exists(s_nodes_done) || !php_cursor[s_nodes_done].isArray() ||
+                !php_cursor.exists(s_nodes) || !php_cursor[s_nodes].isArray()) {
+            return as_error_update(&error, AEROSPIKE_ERR_PARAM,
+                    "Scan cursor must hold ns, set, begin, end, nodes and nodes_done");
+        }
+
+        if (strcmp(php_cursor[s_ns].toString().c_str(), scan_p->ns) ||
+                strcmp(php_cursor[s_set].toString().c_str(), scan_p->set)) {
+            return as_error_update(&error, AEROSPIKE_ERR_PARAM,
+                    "Scan cursor belongs to another namespace/set");
+        }
+
+        int64_t begin = php_cursor[s_begin].toInt64();
+        int64_t end = php_cursor[s_end].toInt64();
+        if (begin < 0 || begin > end || end >= SCAN_PARTITIONS_COUNT) {
+            return as_error_update(&error, AEROSPIKE_ERR_PARAM,
+                    "Scan cursor partitions must be within 0-4095");
+        }
+        if (range.is_set && (range.begin != begin || range.end != end)) {
+            return as_error_update(&error, AEROSPIKE_ERR_PARAM,
+                    "Scan cursor belongs to another partition range");
+        }
+        range.is_set = true;
+        range.begin = (uint16_t) begin;
+        range.end = (uint16_t) end;
+
+        nodes_done = Array::Create();
+        for (ArrayIter iter(php_cursor[s_nodes_done].toArray()); iter; ++iter) {
+            if (!iter.second().isString()) {
+                return as_error_update(&error, AEROSPIKE_ERR_PARAM,
+                        "Scan cursor nodes must be strings");
+            }
+            nodes_done.append(iter.second());
+        }
+
+        nodes = Array::Create();
+        for (ArrayIter iter(php_cursor[s_nodes].toArray()); iter; ++iter) {
+            if (!iter.second().isString()) {
+                return as_error_update(&error, AEROSPIKE_ERR_PARAM,
+                        "Scan cursor nodes must be strings");
+            }
+            nodes.append(iter.second());
+        }
+
+        return error.code;
+    }
+
+    /*
+     *******************************************************************************************
+     * Function to create the cursor of a scan restricted to a partition range,
+     * which can be serialized and passed in again to resume the scan.
+     *
+     * @param scan_p        The as_scan.
+     * @param range         The partition range of the scan.
+     * @param nodes_done    The names of the nodes completed.
+     * @param nodes         The names of the nodes of the cluster when the
+     *                      scan began.
+     * @param complete      Whether all the nodes were completed.
+     * @return the cursor array.
+     *******************************************************************************************
+     */
+    Array create_scan_cursor(const as_scan *scan_p, const scan_partition_range& range,
+            const Array& nodes_done, const Array& nodes, bool complete)
+    {
+        Array php_cursor = Array::Create();
+
+        php_cursor.set(s_ns, String(scan_p->ns, CopyString));
+        php_cursor.set(s_set, String(scan_p->set, CopyString));
+        php_cursor.set(s_begin, (int64_t) range.begin);
+        php_cursor.set(s_end, (int64_t) range.end);
+        php_cursor.set(s_nodes, nodes);
+        php_cursor.set(s_nodes_done, nodes_done);
+        php_cursor.set(s_complete, complete);
+        return php_cursor;
+    }
+
+    /*
+     *******************************************************************************************
+     * Function to scan the records of a partition range, node by node, on
+     * the request thread, skipping the nodes completed already. Each node is
+     * appended to nodes_done once its scan completed, so that a scan which
+     * failed or was stopped can be resumed from the next node. The scan
+     * fails with AEROSPIKE_ERR_CLUSTER_CHANGE if the nodes of the cluster
+     * are no longer the ones it began with, as the partitions of the nodes
+     * completed may have migrated to the nodes left, and it must then be
+     * restarted without a cursor.
+     *
+     * @param as_p          The aerospike instance.
+     * @param scan_policy_p The as_policy_scan of the scan.
+     * @param scan_p        The as_scan, scanned serially.
+     * @param range         The partition range of the scan.
+     * @param nodes_done    The names of the nodes completed, populated by
+     *                      this function.
+     * @param nodes         The names of the nodes of the cluster when the
+     *                      scan began, populated by this function if empty.
+     * @param complete      Set to true if all the nodes were completed.
+     * @param udata         foreach_callback_user_udata reference which
+     *                      contains the PHP user callback function.
+     * @param error         as_error reference to be populated by this function
+     *                      in case of error
+     * @return AEROSPIKE_OK if success. Otherwise AEROSPIKE_ERR_*.
+     *******************************************************************************************
+     */
+    as_status scan_partitions(aerospike *as_p, const as_policy_scan *scan_policy_p,
+            as_scan *scan_p, const scan_partition_range& range, Array& nodes_done,
+            Array& nodes, bool& complete, foreach_callback_user_udata& udata,
+            as_error& error)
+    {
+        std::vector<std::string>    node_names;
+        partition_filter_udata      filter = { &range, &udata };
+
+        as_error_reset(&error);
+        complete = false;
+
+        get_scan_nodes(as_p, node_names);
+        if (node_names.empty()) {
+            return as_error_update(&error, AEROSPIKE_ERR_CLUSTER,
+                    "Scan failed because the cluster is empty");
+        }
+        if (nodes.empty()) {
+            for (const std::string& node_name : node_names) {
+                nodes.append(String(node_name));
+            }
+        }
+
+        /*
+         * A node scanned concurrently would call back on the C client threads
+         */
+        scan_p->concurrent = false;
+        for (const std::string& node_name : node_names) {
+            if (is_scan_node_done(nodes_done, node_name.c_str())) {
+                continue;
+            }
+            if (AEROSPIKE_OK != check_scan_nodes(as_p, nodes, error)) {
+                return error.code;
+            }
+            if (AEROSPIKE_OK != aerospike_scan_node(as_p, &error, scan_policy_p, scan_p,
+                        node_name.c_str(), partition_filter_callback, &filter) ||
+                    udata.stopped || udata.limit_reached) {
+                return error.code;
+            }
+            nodes_done.append(String(node_name));
+        }
+
+        complete = true;
+        return error.code;
     }
 
     /*
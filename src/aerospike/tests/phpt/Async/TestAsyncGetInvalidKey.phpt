@@ -0,0 +1,9 @@
+--TEST--
+getAsync with an invalid key.
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("Async", "testAsyncGetInvalidKey");
+--EXPECT--
+ERR_PARAM
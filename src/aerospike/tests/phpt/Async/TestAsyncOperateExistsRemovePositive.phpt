@@ -0,0 +1,9 @@
+--TEST--
+operateAsync, existsAsync and removeAsync on a record.
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("Async", "testAsyncOperateExistsRemovePositive");
+--EXPECT--
+ERR_RECORD_NOT_FOUND
@@ -0,0 +1,9 @@
+--TEST--
+putAsync and getAsync of records in flight together.
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("Async", "testAsyncPutGetPositive");
+--EXPECT--
+OK
@@ -0,0 +1,9 @@
+--TEST--
+Persistent connect twice to a random host(IP:PORT)
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("Connection", "testPersistentConnectRandomHostTwice");
+--EXPECT--
+ERR_CLUSTER
@@ -0,0 +1,9 @@
+--TEST--
+Basic existsMany returning a bitmap, with a non-existent key.
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("ExistsMany", "testExistsManyBitmapPositive");
+--EXPECT--
+OK
@@ -0,0 +1,9 @@
+--TEST--
+Basic existsMany returning a list of booleans, split into sub-batches.
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("ExistsMany", "testExistsManyBoolsPositive");
+--EXPECT--
+OK
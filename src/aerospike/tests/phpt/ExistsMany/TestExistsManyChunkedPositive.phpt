@@ -0,0 +1,9 @@
+--TEST--
+Basic existsMany split into sub-batches, with positional results.
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("ExistsMany", "testExistsManyChunkedPositive");
+--EXPECT--
+OK
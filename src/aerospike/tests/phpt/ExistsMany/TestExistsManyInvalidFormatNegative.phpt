@@ -0,0 +1,9 @@
+--TEST--
+Basic existsMany, exists format is not a BATCH_EXISTS_* value.
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("ExistsMany", "testExistsManyInvalidFormatNegative");
+--EXPECT--
+ERR_PARAM
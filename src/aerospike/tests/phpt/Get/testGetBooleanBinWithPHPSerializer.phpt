@@ -0,0 +1,9 @@
+--TEST--
+Get a boolean bin, which goes through the serializer and reads back as a boolean.
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("Get", "testGetBooleanBinWithPHPSerializer");
+--EXPECT--
+OK
@@ -0,0 +1,9 @@
+--TEST--
+Get float bins and booleans within a list, stored as native server types.
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("Get", "testGetNativeFloatAndBooleanBins");
+--EXPECT--
+OK
@@ -0,0 +1,9 @@
+--TEST--
+Basic getMany, max in flight sub-batches is not positive.
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("GetMany", "testGetManyChunkedInvalidMaxInFlightNegative");
+--EXPECT--
+ERR_PARAM
@@ -0,0 +1,9 @@
+--TEST--
+Basic getMany split into sub-batches, compared to a single batch.
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("GetMany", "testGetManyChunkedPositive");
+--EXPECT--
+OK
@@ -0,0 +1,9 @@
+--TEST--
+Basic getMany, positional option is not a boolean.
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("GetMany", "testGetManyPositionalInvalidNegative");
+--EXPECT--
+ERR_PARAM
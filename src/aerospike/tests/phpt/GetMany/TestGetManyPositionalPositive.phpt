@@ -0,0 +1,9 @@
+--TEST--
+Basic getMany with positional results, a duplicate and a non-existent key.
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("GetMany", "testGetManyPositionalPositive");
+--EXPECT--
+OK
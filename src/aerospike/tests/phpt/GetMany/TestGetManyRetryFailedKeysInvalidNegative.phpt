@@ -0,0 +1,9 @@
+--TEST--
+Basic getMany, no. of retries of the failed keys is negative.
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("GetMany", "testGetManyRetryFailedKeysInvalidNegative");
+--EXPECT--
+ERR_PARAM
@@ -0,0 +1,9 @@
+--TEST--
+Basic getMany reading the failed keys again.
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("GetMany", "testGetManyRetryFailedKeysPositive");
+--EXPECT--
+OK
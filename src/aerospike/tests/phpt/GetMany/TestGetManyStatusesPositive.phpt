@@ -0,0 +1,9 @@
+--TEST--
+Basic getMany returning the status of each key, positional and not.
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("GetMany", "testGetManyStatusesPositive");
+--EXPECT--
+OK
@@ -0,0 +1,9 @@
+--TEST--
+getManyIterator - connection closed partway through
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("GetManyIterator", "testGetManyIteratorCloseNegative");
+--EXPECT--
+ERR_CLUSTER
@@ -0,0 +1,9 @@
+--TEST--
+getManyIterator with an invalid key.
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("GetManyIterator", "testGetManyIteratorInvalidKeyNegative");
+--EXPECT--
+ERR_PARAM
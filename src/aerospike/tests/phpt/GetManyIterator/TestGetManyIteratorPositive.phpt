@@ -0,0 +1,9 @@
+--TEST--
+getManyIterator over several chunks of records and a non-existent one.
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("GetManyIterator", "testGetManyIteratorPositive");
+--EXPECT--
+OK
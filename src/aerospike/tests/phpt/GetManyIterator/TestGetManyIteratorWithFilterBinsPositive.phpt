@@ -0,0 +1,9 @@
+--TEST--
+getManyIterator with filter bins.
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("GetManyIterator", "testGetManyIteratorWithFilterBinsPositive");
+--EXPECT--
+OK
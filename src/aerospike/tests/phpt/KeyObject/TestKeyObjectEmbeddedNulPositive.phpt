@@ -0,0 +1,9 @@
+--TEST--
+AerospikeKey with string keys differing only after an embedded NUL
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("KeyObject", "testKeyObjectEmbeddedNulPositive");
+--EXPECT--
+OK
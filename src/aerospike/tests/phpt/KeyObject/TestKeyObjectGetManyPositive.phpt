@@ -0,0 +1,9 @@
+--TEST--
+getMany with AerospikeKey objects and key arrays.
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("KeyObject", "testKeyObjectGetManyPositive");
+--EXPECT--
+OK
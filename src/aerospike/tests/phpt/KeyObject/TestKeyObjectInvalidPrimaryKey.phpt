@@ -0,0 +1,9 @@
+--TEST--
+AerospikeKey with an invalid primary key.
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("KeyObject", "testKeyObjectInvalidPrimaryKey");
+--EXPECT--
+ERR_PARAM
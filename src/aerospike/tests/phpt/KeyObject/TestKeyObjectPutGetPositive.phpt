@@ -0,0 +1,9 @@
+--TEST--
+PUT, GET, EXISTS and REMOVE with an AerospikeKey.
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("KeyObject", "testKeyObjectPutGetPositive");
+--EXPECT--
+OK
@@ -0,0 +1,9 @@
+--TEST--
+operateMany with a stale generation.
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("OperateMany", "testOperateManyGenerationMismatch");
+--EXPECT--
+ERR_RECORD_GENERATION
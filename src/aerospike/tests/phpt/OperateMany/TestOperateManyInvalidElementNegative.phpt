@@ -0,0 +1,9 @@
+--TEST--
+operateMany with an element missing its operations.
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("OperateMany", "testOperateManyInvalidElementNegative");
+--EXPECT--
+ERR_PARAM
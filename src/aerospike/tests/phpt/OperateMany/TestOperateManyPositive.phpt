@@ -0,0 +1,9 @@
+--TEST--
+operateMany incrementing and reading a bin of many records.
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("OperateMany", "testOperateManyPositive");
+--EXPECT--
+OK
@@ -0,0 +1,9 @@
+--TEST--
+PUT with an AerospikePolicy holding POLICY_EXISTS_CREATE on an existing record.
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("Policy", "testPolicyExistsCreateOnRecordExists");
+--EXPECT--
+ERR_RECORD_EXISTS
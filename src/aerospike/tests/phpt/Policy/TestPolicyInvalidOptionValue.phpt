@@ -0,0 +1,9 @@
+--TEST--
+AerospikePolicy with an invalid option value.
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("Policy", "testPolicyInvalidOptionValue");
+--EXPECT--
+ERR_PARAM
@@ -0,0 +1,9 @@
+--TEST--
+PUT and GET with a precompiled AerospikePolicy.
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("Policy", "testPolicyPutGetPositive");
+--EXPECT--
+OK
@@ -0,0 +1,9 @@
+--TEST--
+Put - List bin with more than 4096 nested elements.
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("Put", "testPutLargeNestedListPositive");
+--EXPECT--
+OK
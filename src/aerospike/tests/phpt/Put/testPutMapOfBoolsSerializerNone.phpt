@@ -6,4 +6,4 @@ PUT Map of bools and serializer option is SERIALIZER_NONE.
 include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
 aerospike_phpt_runtest("Put", "testPutMapOfBoolsSerializerNone");
 --EXPECT--
-ERR_PARAM
+OK
@@ -6,4 +6,4 @@ PUT Map of floats and serializer option is SERIALIZER_NONE.
 include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
 aerospike_phpt_runtest("Put", "testPutMapOfFloatsSerializerNone");
 --EXPECT--
-ERR_PARAM
+OK
@@ -0,0 +1,9 @@
+--TEST--
+putMany with a record missing its bins.
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("PutMany", "testPutManyInvalidRecordNegative");
+--EXPECT--
+ERR_PARAM
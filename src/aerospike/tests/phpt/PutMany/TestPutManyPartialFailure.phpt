@@ -0,0 +1,9 @@
+--TEST--
+putMany with one record failing on POLICY_EXISTS_CREATE.
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("PutMany", "testPutManyPartialFailure");
+--EXPECT--
+ERR_RECORD_EXISTS
@@ -0,0 +1,9 @@
+--TEST--
+Basic putMany operation of 100 records.
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("PutMany", "testPutManyPositive");
+--EXPECT--
+OK
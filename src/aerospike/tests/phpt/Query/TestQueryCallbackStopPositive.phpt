@@ -0,0 +1,9 @@
+--TEST--
+Query - stopped by the callback
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("Query", "testQueryCallbackStopPositive");
+--EXPECT--
+OK
@@ -0,0 +1,9 @@
+--TEST--
+Query - negative max records
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("Query", "testQueryMaxRecordsInvalidNegative");
+--EXPECT--
+ERR_PARAM
@@ -0,0 +1,9 @@
+--TEST--
+Query - stopped by the client after the max records
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("Query", "testQueryMaxRecordsPositive");
+--EXPECT--
+OK
@@ -0,0 +1,9 @@
+--TEST--
+QueryIterator - where predicate is not an array
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("QueryIterator", "testQueryIteratorInvalidPredicateNegative");
+--EXPECT--
+ERR_PARAM
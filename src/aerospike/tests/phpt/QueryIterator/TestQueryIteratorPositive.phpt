@@ -0,0 +1,9 @@
+--TEST--
+QueryIterator - iterate over the records of a range query
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("QueryIterator", "testQueryIteratorPositive");
+--EXPECT--
+OK
@@ -0,0 +1,9 @@
+--TEST--
+QueryIterator - consumed through a generator and released early
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("QueryIterator", "testQueryIteratorReleasedEarlyPositive");
+--EXPECT--
+OK
@@ -0,0 +1,9 @@
+--TEST--
+removeMany with an invalid key.
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("RemoveMany", "testRemoveManyInvalidKeyNegative");
+--EXPECT--
+ERR_PARAM
@@ -0,0 +1,9 @@
+--TEST--
+removeMany of many records and a non-existent one.
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("RemoveMany", "testRemoveManyPositive");
+--EXPECT--
+OK
@@ -0,0 +1,9 @@
+--TEST--
+Scan - negative callback chunk size
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("Scan", "testScanChunkedCallbackInvalidChunkSizeNegative");
+--EXPECT--
+ERR_PARAM
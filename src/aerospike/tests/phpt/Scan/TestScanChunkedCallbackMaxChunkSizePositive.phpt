@@ -0,0 +1,9 @@
+--TEST--
+Basic SCAN with the max callback chunk size, larger than the set
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("Scan", "testScanChunkedCallbackMaxChunkSizePositive");
+--EXPECT--
+OK
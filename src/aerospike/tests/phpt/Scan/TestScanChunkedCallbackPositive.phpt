@@ -0,0 +1,9 @@
+--TEST--
+Scan - records delivered to the callback in chunks
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("Scan", "testScanChunkedCallbackPositive");
+--EXPECT--
+OK
@@ -0,0 +1,9 @@
+--TEST--
+Scan - stopped by the callback of the first chunk
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("Scan", "testScanChunkedCallbackStopPositive");
+--EXPECT--
+OK
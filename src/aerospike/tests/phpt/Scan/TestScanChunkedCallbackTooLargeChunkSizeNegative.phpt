@@ -0,0 +1,9 @@
+--TEST--
+Basic SCAN Check with a callback chunk size above the max
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("Scan", "testScanChunkedCallbackTooLargeChunkSizeNegative");
+--EXPECT--
+ERR_PARAM
@@ -0,0 +1,9 @@
+--TEST--
+Scan - concurrent scan handing records over to the callback through a buffer
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("Scan", "testScanConcurrentlyBufferedCallbackPositive");
+--EXPECT--
+OK
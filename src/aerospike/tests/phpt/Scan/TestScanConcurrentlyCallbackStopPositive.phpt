@@ -0,0 +1,9 @@
+--TEST--
+Scan - nodes scanned in parallel, stopped by the callback
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("Scan", "testScanConcurrentlyCallbackStopPositive");
+--EXPECT--
+OK
@@ -0,0 +1,9 @@
+--TEST--
+Scan - concurrent scan stopped by the callback
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("Scan", "testScanConcurrentlyStopPositive");
+--EXPECT--
+OK
@@ -0,0 +1,9 @@
+--TEST--
+Scan - resume from the cursor of a scan begun on other nodes
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("Scan", "testScanCursorClusterChangedNegative");
+--EXPECT--
+ERR_CLUSTER_CHANGE
@@ -0,0 +1,9 @@
+--TEST--
+Scan - resuming from the cursor of another set
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("Scan", "testScanCursorOtherSetNegative");
+--EXPECT--
+ERR_PARAM
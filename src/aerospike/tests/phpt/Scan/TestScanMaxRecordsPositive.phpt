@@ -0,0 +1,9 @@
+--TEST--
+Scan - concurrent scan stopped by the client after the max records
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("Scan", "testScanMaxRecordsPositive");
+--EXPECT--
+OK
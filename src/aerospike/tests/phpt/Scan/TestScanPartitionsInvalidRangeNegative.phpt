@@ -0,0 +1,9 @@
+--TEST--
+Scan - partition range beyond the last partition
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("Scan", "testScanPartitionsInvalidRangeNegative");
+--EXPECT--
+ERR_PARAM
@@ -0,0 +1,9 @@
+--TEST--
+Scan - the two halves of the partitions scanned separately
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("Scan", "testScanPartitionsPositive");
+--EXPECT--
+OK
@@ -0,0 +1,9 @@
+--TEST--
+Scan - partition range scan resumed from its cursor
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("Scan", "testScanPartitionsResumePositive");
+--EXPECT--
+OK
@@ -0,0 +1,9 @@
+--TEST--
+ScanApply - returns before the scan completes, polling its job handle
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("ScanApply", "testScanApplyJobInfoPositive");
+--EXPECT--
+OK
@@ -0,0 +1,9 @@
+--TEST--
+ScanApply - wait for the scan through its job handle
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("ScanApply", "testScanApplyJobWaitPositive");
+--EXPECT--
+OK
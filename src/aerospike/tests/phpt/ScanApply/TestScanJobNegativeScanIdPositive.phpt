@@ -0,0 +1,9 @@
+--TEST--
+ScanJob - scan id above the max signed 64-bit integer
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("ScanApply", "testScanJobNegativeScanIdPositive");
+--EXPECT--
+OK
@@ -0,0 +1,9 @@
+--TEST--
+ScanJob - scan id is a string
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("ScanApply", "testScanJobScanIdIsStringNegative");
+--EXPECT--
+ERR_PARAM
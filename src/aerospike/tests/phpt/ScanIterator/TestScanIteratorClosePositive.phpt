@@ -0,0 +1,9 @@
+--TEST--
+scanIterator closed before the end of the scan.
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("ScanIterator", "testScanIteratorClosePositive");
+--EXPECT--
+OK
@@ -0,0 +1,9 @@
+--TEST--
+scanIterator over a string bin holding an embedded NUL.
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("ScanIterator", "testScanIteratorEmbeddedNulPositive");
+--EXPECT--
+OK
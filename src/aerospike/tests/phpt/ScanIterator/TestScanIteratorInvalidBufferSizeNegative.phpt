@@ -0,0 +1,9 @@
+--TEST--
+scanIterator, buffer size is not positive.
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("ScanIterator", "testScanIteratorInvalidBufferSizeNegative");
+--EXPECT--
+ERR_PARAM
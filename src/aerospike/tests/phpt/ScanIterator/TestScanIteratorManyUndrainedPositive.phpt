@@ -0,0 +1,9 @@
+--TEST--
+scanIterator, more iterators left undrained than there are async command workers
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("ScanIterator", "testScanIteratorManyUndrainedPositive");
+--EXPECT--
+OK
@@ -0,0 +1,9 @@
+--TEST--
+scanIterator over a set, through a buffer smaller than the set.
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("ScanIterator", "testScanIteratorPositive");
+--EXPECT--
+OK
@@ -0,0 +1,9 @@
+--TEST--
+selectMany with both bins and header only for a key.
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("SelectMany", "testSelectManyBinsAndHeaderOnlyNegative");
+--EXPECT--
+ERR_PARAM
@@ -0,0 +1,9 @@
+--TEST--
+selectMany with an element missing its key.
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("SelectMany", "testSelectManyMissingKeyNegative");
+--EXPECT--
+ERR_PARAM
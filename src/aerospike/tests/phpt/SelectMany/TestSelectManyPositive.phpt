@@ -0,0 +1,9 @@
+--TEST--
+selectMany with all bins, selected bins, header only and a non-existent key.
+
+--FILE--
+<?php
+include dirname(__FILE__)."/../../astestframework/astest-phpt-loader.inc";
+aerospike_phpt_runtest("SelectMany", "testSelectManyPositive");
+--EXPECT--
+OK